@@ -4,15 +4,17 @@
  * of the Carousel cage project.
  * 
  * Due problems to control seriously the DF mp3 player with Arduino MKR1000 a dedicated custom mp3
- * player ased on this board has been designed. It is controlled by a trigger pin by the MKR1000
- * that on request only send the input to start the play operation. The soundtrack management sequence
+ * player ased on this board has been designed. It is controlled by the MKR1000 with the serial link
+ * in soundlink.h (play a track, next track, volume, fade out, stop, status and track ended events).
+ * When the link is not connected the player follows the trigger pin by the MKR1000 that on request
+ * only send the input to start the play operation. The soundtrack management sequence
  * is automatically started on-demand (by the triggered pin) and executes the piece from the sequence,  
  * changing it everytime for about 60 seconds  including dissolve in and out. 
  * 
  * @note The player uses the same serial used also to program the Nano via USB to when a new program should
- * be uploaded the serial wires should be disconnected. For more details on the DFPlayerMini Arduino library 
- * please read the GitHub (sources docmentation includes more detailed information than the wiki). Read the 
- * DFRobotDFPlayerMini.h header file fo the constant definitions to set all the parameters.\n
+ * be uploaded the serial wires should be disconnected. The player is controlled by the asynchronous command
+ * queue in player.h, so the commands are sent as soon as the player acknowledges the previous one and the
+ * sketch never waits for the player. The command IDs are defined in globals.h (see the DFPlayer datasheet).\n
  * Using Arduino Mega or Mega2560 platforms you can set the player serial to one different than the USB serial
  * e.g. Serial1
  * 
@@ -21,7 +23,8 @@
  * automatically generated by the OSX that create noisy silent playing of undesired ghost files.
  * 
  * @note The mp3 files should be named in a numerical sequence 001.mp3 ... xxx.mp3. Files can be organized in folders
- * named in sequence 01 .. nn and every folder can contain a max of 255 files.
+ * named in sequence 01 .. nn and every folder can contain a max of 255 files. The tracks played, with their
+ * folder and weight in the shuffled playlist are listed in tracks.h.
  * The DF PLayer support microSD cards up to 32 Gb. For more details read the datasheet in the Doc folder of the
  * repository.
  * 
@@ -35,86 +38,214 @@
  */
 
 #include "globals.h"
+#include "volume.h"
+#include "player.h"
+#include "soundlink.h"
+#include "analogfilter.h"
+#include "playlist.h"
+#include <SoftwareSerial.h>
 
-//! Instance of the DF mp player class
-DFRobotDFPlayerMini libDFPlayer;
+//! DF mp3 player command queue
+PlayerQueue player;
 //! Player control structure
 SoundControl playerControl;
+//! Volume fade engine
+VolumeFader volumeFader;
+//! Serial connected to the carousel board
+SoftwareSerial linkSerial(SOUND_LINK_RX_PIN, SOUND_LINK_TX_PIN);
+//! Serial link with the carousel board
+SoundLink soundLink;
+//! Max volume knob
+AnalogFilter volumeKnob;
+//! Soundtrack playlist
+Playlist playlist;
 
 // =============================================================
 //                    Player Functions
 // =============================================================
 
-//! Initialize the player start parameters
+/**
+ * Queue the player start parameters. The player has just been powered
+ * on (or it has notified a reset) so it is not reset again; the commands
+ * are sent by the queue as soon as the player accepts them
+ */
 void initPlayer() {
-  //Set serial communictaion time out 500ms
-  libDFPlayer.setTimeOut(SERIAL_TIMEOUT); 
-  //----Set device we uset----
-  libDFPlayer.reset();     //Reset the module
-  delay(COMMAND_DELAY);
   //----Set volume----
-  libDFPlayer.volume(playerControl.volume);  //Set volume value (0~30).
-  delay(COMMAND_DELAY);
+  player.volume(playerControl.volume);  //Set volume value (0~30).
   //----Set Equalization----
-  libDFPlayer.EQ(EQUALIZATION);
-  delay(COMMAND_DELAY);
+  player.EQ(EQUALIZATION);
   //----Set device we uset----
-  libDFPlayer.outputDevice(MP3_DEVICE);
-  delay(COMMAND_DELAY);
+  player.outputDevice(MP3_DEVICE);
+}
+
+/**
+ * Check the player notifications. If the player has been reset (e.g. a
+ * brown-out of the player only) the start parameters are sent again and
+ * the song restarts when the trigger is active. A track finished confirms
+ * the length of the track measured by the playlist
+ */
+void checkPlayerEvents() {
+  byte evt;
+  unsigned int param;
+
+  if(player.readEvent(evt, param) == true) {
+    if(evt == PLAYER_EVT_ONLINE) {
+      playerControl.volume = START_VOLUME;
+      playerControl.isPlaying = false;
+      playerControl.isFadingOut = false;
+      volumeFader.begin(playerControl.volume, millis());
+      initPlayer();
+    } else if(evt == PLAYER_EVT_FINISHED) {
+      playlist.finished();
+    }
+  }
 }
 
 /**
  * Read the dynamic max volume target and update the sructure
  */
 void getDynamicVolume() {
-  int analogVol = analogRead(ANALOG_FADE_PIN);
+  int analogVol = volumeKnob.getValue();
   // Map the analog value to the absolute max volume
   // on a scale from 0 to 1024
   playerControl.maxVolume = map(analogVol, 0, 1023, START_VOLUME, MAX_VOLUME);
+  // The volume set by the carousel board wins on the trimmer
+  if(playerControl.linkVolume > 0) {
+    playerControl.maxVolume = playerControl.linkVolume;
+  }
 }
 
 // Check if the dynamics volume has changed. If so, update the
 // value accordingly
 void checkDynamicVolume() {
-  int analogVol = analogRead(ANALOG_FADE_PIN);
-  // Map the analog value to the absolute max volume
-  // on a scale from 0 to 1024
-  int mappedVolume = map(analogVol, 0, 1023, START_VOLUME, MAX_VOLUME);
-  // If volume has changed update the volme of the player
-  if(mappedVolume > playerControl.maxVolume) {
-    // Volume shoud grow
-    fadeVolume(FADE_IN);
-  } else {
-    // Volume shoud go lower
-    fadeVolume(FADE_OUT);
+  getDynamicVolume();
+  // If volume has changed fade to the new volume. Nothing changes
+  // if the fader is already going there
+  volumeFader.fadeTo(playerControl.maxVolume, FADE_DYNAMIC_TIME, FADE_SMOOTH, millis());
+}
+
+/**
+ * Send the volume of the running fade to the player, when the player
+ * serial has a free slot and the volume has changed
+ * 
+ * @param now The current time (ms)
+ */
+void updateVolume(unsigned long now) {
+  int v = volumeFader.update(now);
+
+  if(v >= 0) {
+    playerControl.volume = v;
+    player.volume(playerControl.volume);
   }
 }
 
 /**
- * Fade in or out the volume, accordingly with the parameter, in the min and max volume range
+ * Get the number of the next song of the playlist
+ */
+int getNextSong() {
+  return playlist.next() + 1;
+}
+
+/**
+ * Play a song at the current volume
  * 
- * @param inout If inout is > 0 the volume is fade in else it is fadeout
+ * @param song The song number
+ * @param next True if the song follows the playing one, that is ending
+ * @param now The current time (ms)
  */
-void fadeVolume(int inout) {
-  int j;
+void playSong(int song, boolean next, unsigned long now) {
+  TrackInfo track = playlist.getTrack(song - 1);
+
+  playerControl.currentSong = song;
+  player.play(track.folder, track.file);
+  playlist.start(song - 1, next, now);
+  volumeFader.commandSent(now);
+}
 
+/**
+ * Start playing a song, fading in from the start volume. The following
+ * songs of the playlist start just before the playing one ends, or when the
+ * player busy pin shows it ended if its length is not known yet
+ * 
+ * @param song The song number
+ * @param now The current time (ms)
+ */
+void startSong(int song, unsigned long now) {
+  playerControl.isPlaying = true;
+  playerControl.isFadingOut = false;
+  // A new song always starts from the start volume
+  playerControl.volume = START_VOLUME;
+  player.volume(playerControl.volume);
+  playSong(song, false, now);
+  volumeFader.begin(playerControl.volume, now);
   getDynamicVolume();
-  
-  if (inout == FADE_IN) {
-    // fade from current volume to max
-    for(j = playerControl.volume; j <= playerControl.maxVolume; j++) {
-      playerControl.volume = j;
-      libDFPlayer.volume(playerControl.volume);
-    }
+  volumeFader.fadeTo(playerControl.maxVolume, FADE_IN_TIME, FADE_IN_CURVE, now);
+}
+
+/**
+ * Fade out the playing song. The player is paused at the end of the fade
+ * 
+ * @param ms The fade duration (ms)
+ * @param now The current time (ms)
+ */
+void fadeOutSong(unsigned long ms, unsigned long now) {
+  if( (playerControl.isPlaying == true) && (playerControl.isFadingOut == false) ) {
+    playerControl.isFadingOut = true;
+    volumeFader.fadeTo(START_VOLUME, ms, FADE_OUT_CURVE, now);
   }
-  else {
-    // fade from current volume to min
-    for(j = playerControl.volume; j >= START_VOLUME; j--) {
-      playerControl.volume = j;
-      libDFPlayer.volume(playerControl.volume);
+}
+
+/**
+ * Pause the player immediately
+ * 
+ * @param now The current time (ms)
+ */
+void stopSong(unsigned long now) {
+  player.pause();
+  volumeFader.commandSent(now);
+  playerControl.isPlaying = false;
+  playerControl.isFadingOut = false;
+}
+
+/**
+ * Execute the commands received from the carousel board
+ * 
+ * @param now The current time (ms)
+ */
+void checkLink(unsigned long now) {
+  LinkFrame f;
+
+  while(soundLink.read(f, now)) {
+    switch(f.cmd) {
+      case SOUND_CMD_PLAY:
+        if( (f.param >= 1) && (f.param <= NUMTRACKS) ) {
+          startSong(f.param, now);
+        }
+      break;
+      case SOUND_CMD_NEXT:
+        startSong(getNextSong(), now);
+      break;
+      case SOUND_CMD_VOLUME:
+        playerControl.linkVolume = constrain(f.param, 0, MAX_VOLUME);
+        if( (playerControl.isPlaying == true) && (playerControl.isFadingOut == false) ) {
+          checkDynamicVolume();
+        }
+      break;
+      case SOUND_CMD_FADE:
+        fadeOutSong(f.param, now);
+      break;
+      case SOUND_CMD_STOP:
+        stopSong(now);
+      break;
+      case SOUND_CMD_STATUS:
+        if(playerControl.isPlaying == true) {
+          soundLink.send(SOUND_EVT_STATUS, playerControl.currentSong);
+        } else {
+          soundLink.send(SOUND_EVT_STATUS, 0);
+        }
+      break;
     }
   }
-    
 }
 
 /**
@@ -141,56 +272,96 @@ void setup() {
 
   pinMode(TRIGGER_PIN, INPUT_PULLUP);
   pinMode(TRIGGER_LED, OUTPUT);
+  pinMode(BUSY_PIN, INPUT);
+  randomSeed(analogRead(PLAYLIST_SEED_PIN));
+  playlist.begin(PLAYLIST_SHUFFLE);
+  volumeKnob.begin(ANALOG_FADE_PIN, VOLUME_OVERSAMPLE, VOLUME_FILTER_SHIFT,
+                   VOLUME_HYSTERESIS, VOLUME_SAMPLE_TIME, millis());
 
-  libDFPlayer.begin(Serial);
-  delay(1000);
-
-  // Wait untile the Arduino serial connected to the player
-  if (!libDFPlayer.begin(Serial)) {
-    while(true);
-  }
-
+  player.begin(Serial);
   initPlayer();
+
+  linkSerial.begin(SOUND_LINK_SPEED);
+  soundLink.begin(linkSerial);
+  volumeFader.begin(playerControl.volume, millis());
 }
 
 /**
  * Main loop
+ * 
+ * Nothing waits in the loop: the fades are advanced by the volume fader
+ * every time, so a trigger change is honored also in the middle of a fade.
+ * The trigger pin is ignored while the carousel board commands the player
+ * on the serial link.
  */
 void loop()
 {
+  unsigned long now;
+
+  // Send the queued commands and read the player answers
+  now = millis();
+  player.update(now);
+  checkPlayerEvents();
+
+  // Commands from the carousel board
+  checkLink(now);
+
   // Check the start/stop trigger
   isTrigger();
 
-  // The trigger is active
-  if(playerControl.trigger == true) {
-    // Check if is already playing
-    if(playerControl.isPlaying == false) {
-      // Update the song
-      playerControl.currentSong++;
-      if(playerControl.currentSong > MAX_SONGS) {
-        // Reset the song counter
-        playerControl.currentSong = 1;
-      } // Updated player status and song
-      playerControl.isPlaying = true;
-      // Start playing with a fadein the new song and loop
-      // until the trigger is not reset
-      libDFPlayer.loop(playerControl.currentSong);
-      fadeVolume(FADE_IN);
-    } // Playing started
-//    else { // Not used
-//      // Is already playing, check if the target volume has changed
-//      checkDynamicVolume();
-//    }
-  } // Trigger is set
-  else {
-    // Trigger is not active, check if is playing and fade out the song
-    if(playerControl.isPlaying == true)
-    // Fade out the song
-    fadeVolume(FADE_OUT);
-    // Put the player in pause
-    libDFPlayer.pause();
-    playerControl.isPlaying = false;
-  } // Playing stopped
+  // The link has been lost: the volume set by the carousel board is
+  // not valid anymore, the trimmer is used again
+  if( (playerControl.isLinked == true) && (soundLink.isConnected(now) == false) ) {
+    playerControl.linkVolume = 0;
+    if( (playerControl.isPlaying == true) && (playerControl.isFadingOut == false) ) {
+      checkDynamicVolume();
+    }
+  }
+  playerControl.isLinked = soundLink.isConnected(now);
+
+  if(playerControl.isLinked == false) {
+    // The trigger is active
+    if(playerControl.trigger == true) {
+      // Check if is already playing
+      if(playerControl.isPlaying == false) {
+        // Start playing with a fadein the next song and loop
+        // until the trigger is not reset
+        startSong(getNextSong(), now);
+      } // Playing started
+      else if(playerControl.isFadingOut == true) {
+        // The trigger is back during the fade out, fade in
+        // again the same song from the current volume
+        playerControl.isFadingOut = false;
+        getDynamicVolume();
+        volumeFader.fadeTo(playerControl.maxVolume, FADE_IN_TIME, FADE_IN_CURVE, now);
+      } // Fade out cancelled
+    } // Trigger is set
+    else {
+      // Trigger is not active, fade out the song if is playing
+      fadeOutSong(FADE_OUT_TIME, now);
+    } // Playing stopped
+  } // Trigger fallback
+
+  // Is already playing, check if the volume knob has moved
+  if( (volumeKnob.update(now) == true) && (playerControl.isPlaying == true) &&
+      (playerControl.isFadingOut == false) ) {
+    checkDynamicVolume();
+  }
+
+  // Move to the next song when the playing one is ending
+  if( (playerControl.isPlaying == true) && (playerControl.isFadingOut == false) &&
+      playlist.isTrackEnd(digitalRead(BUSY_PIN) == HIGH, now) ) {
+    soundLink.send(SOUND_EVT_ENDED, playerControl.currentSong);
+    playSong(getNextSong(), true, now);
+  }
+
+  // Advance the running fade
+  updateVolume(now);
+
+  if( (playerControl.isFadingOut == true) && (volumeFader.isRunning() == false) ) {
+    // Fade out completed, put the player in pause
+    stopSong(now);
+  }
 }
 
 void printDetail(uint8_t type, int value){
@@ -0,0 +1,55 @@
+/**
+ * \file analogfilter.cpp
+ * \brief Filtered analog input reader
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "analogfilter.h"
+
+void AnalogFilter::begin(int analogPin, int reads, int weight, int band, unsigned long ms, unsigned long now) {
+  pin = analogPin;
+  oversample = max(reads, 1);
+  shift = weight;
+  hysteresis = band;
+  interval = ms;
+  timerSample = now;
+  value = sample();
+  average = long(value) << shift;
+}
+
+int AnalogFilter::sample() {
+  long sum = 0;
+  int j;
+
+  for(j = 0; j < oversample; j++) {
+    sum += analogRead(pin);
+  }
+  return int(sum / oversample);
+}
+
+boolean AnalogFilter::update(unsigned long now) {
+  int filtered;
+
+  if((now - timerSample) < interval) {
+    return false;
+  }
+  timerSample = now;
+
+  // Exponential moving average
+  average += sample() - (average >> shift);
+  filtered = int(average >> shift);
+
+  if(abs(filtered - value) <= hysteresis) {
+    // Noise, keep the reported value
+    return false;
+  }
+  value = filtered;
+  return true;
+}
+
+int AnalogFilter::getValue() {
+  return value;
+}
@@ -0,0 +1,79 @@
+/**
+ * \file analogfilter.h
+ * \brief Filtered analog input reader
+ * 
+ * Reads an analog input at a fixed rate and smooths the ADC noise out:
+ * - every sample is the average of some consecutive reads (oversampling)
+ * - the samples are filtered by an exponential moving average, with the
+ *   weight of the new sample 1 / 2^shift
+ * - the filtered value is reported only when it moves out of a hysteresis
+ *   band around the last reported value
+ * 
+ * The input is read at most once every interval ms, so the time spent
+ * on the ADC is bounded also when update() is called every loop. The
+ * reported value only changes when the input really moves, e.g. a knob
+ * turned by hand.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _ANALOGFILTER
+#define _ANALOGFILTER
+
+#include "Arduino.h"
+
+//! Oversampled, filtered and hysteretic analog input
+class AnalogFilter {
+  private:
+  //! Analog pin
+  int pin;
+  //! Number of reads averaged in a sample
+  int oversample;
+  //! Weight of the new sample in the moving average, as a power of 2
+  int shift;
+  //! Min change of the filtered value to be reported
+  int hysteresis;
+  //! Min time (ms) between two samples
+  unsigned long interval;
+  //! Time (ms) of the last sample
+  unsigned long timerSample;
+  //! Moving average, scaled by 2^shift
+  long average;
+  //! Last reported value
+  int value;
+
+  /**
+   * Read the oversampled input
+   */
+  int sample();
+
+  public:
+  /**
+   * Set the filter parameters and initialize it with the current input
+   * 
+   * @param analogPin The analog pin
+   * @param reads The number of reads averaged in a sample
+   * @param weight The weight of the new sample, 1 / 2^weight
+   * @param band The min change of the filtered value to be reported
+   * @param ms The min time (ms) between two samples
+   * @param now The current time (ms)
+   */
+  void begin(int analogPin, int reads, int weight, int band, unsigned long ms, unsigned long now);
+
+  /**
+   * Read a new sample, if the interval has passed, and update the filter
+   * 
+   * @param now The current time (ms)
+   * @return true if the reported value has changed
+   */
+  boolean update(unsigned long now);
+
+  /**
+   * Get the last reported value (0-1023)
+   */
+  int getValue();
+};
+
+#endif
@@ -4,32 +4,124 @@
  */
 
 #include "Arduino.h"
-#include "DFRobotDFPlayerMini.h"
 
 #ifndef _GLOBALS
 #define _GLOBALS
 
 #define TRIGGER_PIN 2   ///< Pin that trigger the playing of a song
 #define TRIGGER_LED 13  ///< LED to monitor the state of the trigger
+#define BUSY_PIN 3      ///< Player busy pin, low while a track is playing
+
+#define SOUND_LINK_RX_PIN 8         ///< Serial link with the carousel board, receive
+#define SOUND_LINK_TX_PIN 9         ///< Serial link with the carousel board, transmit
+#define SOUND_LINK_SPEED 57600      ///< Link speed, a frame takes less than a 9600 baud byte
+#define SOUND_LINK_START 0xA5       ///< Frame start byte
+#define SOUND_LINK_FRAME_LEN 5      ///< Frame length
+#define SOUND_LINK_TIMEOUT 1500UL   ///< Time (ms) without frames the link is considered broken
+
+#define SOUND_CMD_PLAY 0x01         ///< Play the track in the parameter
+#define SOUND_CMD_NEXT 0x02         ///< Play the next track
+#define SOUND_CMD_VOLUME 0x03       ///< Set the max volume, 0 to use the trimmer
+#define SOUND_CMD_FADE 0x04         ///< Fade out in the parameter time (ms) and stop
+#define SOUND_CMD_STOP 0x05         ///< Stop immediately
+#define SOUND_CMD_STATUS 0x06       ///< Request the player status
+#define SOUND_EVT_STATUS 0x81       ///< Player status, the track playing or 0
+#define SOUND_EVT_ENDED 0x82        ///< The track in the parameter is finished
 
 #define START_VOLUME 3 ///< Initial volume for the fade in/out when a new song starts
 /**
  * The maximum volume level is proportional. It is the absolue limits that can be reached but
  * maybe lower, depending on the settings of the trimmer connected to the analog port to regulate
- * the effective playing volume (depending on the noise of the environmnet)
+ * the effective playing volume (depending on the noise of the environmnet). The whole trimmer
+ * travel is mapped up to the max volume accepted by the player
  */
-#define MAX_VOLUME 80
+#define MAX_VOLUME PLAYER_MAX_VOLUME
 
-#define MAX_SONGS 13                    ///< Max number of songs, starting counting from 1
-#define EQUALIZATION DFPLAYER_EQ_POP    ///< The equalization kind
-#define MP3_DEVICE DFPLAYER_DEVICE_SD   ///< if used an USB instead, change this value accordingly
+#define NUMTRACKS 13                    ///< Number of tracks in the playlist table (see tracks.h)
+#define PLAYLIST_SHUFFLE true           ///< Play the tracks in random order
+#define PLAYLIST_PREISSUE 150UL         ///< Time (ms) added to the player seek time to start the next track before the end
+#define PLAYLIST_START_TIMEOUT 5000UL   ///< Max time (ms) from a play to the busy pin low, then the track is skipped
+#define PLAYLIST_EEPROM_ADDRESS 0       ///< EEPROM address of the track lengths measured
+#define PLAYLIST_EEPROM_MAGIC 0xC5      ///< Marks the EEPROM with the track lengths
+#define PLAYLIST_SEED_PIN 1             ///< Unconnected analog port, its noise seeds the shuffle
+#define EQUALIZATION PLAYER_EQ_POP      ///< The equalization kind
+#define MP3_DEVICE PLAYER_DEVICE_SD     ///< if used an USB instead, change this value accordingly
 #define SERIAL_SPEED 9600               ///< Communication speed (see DFPlayer datasheet)
-#define SERIAL_TIMEOUT 500              ///< Player communication timeour (ms)
-#define COMMAND_DELAY 800               ///< Delay betwee commands (ms)
+
+// Player commands and events (see DFPlayer datasheet)
+#define PLAYER_CMD_PLAY 0x03            ///< Play a track of the root folder
+#define PLAYER_CMD_VOLUME 0x06          ///< Set the volume
+#define PLAYER_CMD_EQ 0x07              ///< Set the equalization
+#define PLAYER_CMD_DEVICE 0x09          ///< Set the playing device
+#define PLAYER_CMD_START 0x0D           ///< Resume playing
+#define PLAYER_CMD_PAUSE 0x0E           ///< Pause
+#define PLAYER_CMD_FOLDER 0x0F          ///< Play a file of a folder (folder high byte, file low byte)
+#define PLAYER_EVT_FINISHED 0x3D        ///< Track on the microSD finished
+#define PLAYER_EVT_ONLINE 0x3F          ///< Player initialized, after power on or reset
+#define PLAYER_EVT_ERROR 0x40           ///< Command error, the command should be sent again
+#define PLAYER_EVT_ACK 0x41             ///< Command acknowledge
+
+#define PLAYER_EQ_POP 1                 ///< Pop equalization
+#define PLAYER_DEVICE_SD 2              ///< Play from the microSD card
+#define PLAYER_MAX_VOLUME 30            ///< Max volume accepted by the player
+
+// Player frame
+#define PLAYER_START 0x7E               ///< Frame start byte
+#define PLAYER_VERSION 0xFF             ///< Protocol version byte
+#define PLAYER_LENGTH 0x06              ///< Length of the frame, from the version to the parameter
+#define PLAYER_END 0xEF                 ///< Frame end byte
+#define PLAYER_FRAME_START 0            ///< Position of the start byte in the frame
+#define PLAYER_FRAME_VERSION 1          ///< Position of the version byte in the frame
+#define PLAYER_FRAME_LENGTH 2           ///< Position of the length byte in the frame
+#define PLAYER_FRAME_CMD 3              ///< Position of the command byte in the frame
+#define PLAYER_FRAME_ACK 4              ///< Position of the acknowledge request in the frame
+#define PLAYER_FRAME_PARAM_H 5          ///< Position of the parameter high byte in the frame
+#define PLAYER_FRAME_PARAM_L 6          ///< Position of the parameter low byte in the frame
+#define PLAYER_FRAME_CHECK_H 7          ///< Position of the checksum high byte in the frame
+#define PLAYER_FRAME_CHECK_L 8          ///< Position of the checksum low byte in the frame
+#define PLAYER_FRAME_END 9              ///< Position of the end byte in the frame
+#define PLAYER_FRAME_LEN 10             ///< Frame length
+
+#define PLAYER_QUEUE_SIZE 8             ///< Max number of commands waiting to be sent
+#define PLAYER_ACK_TIMEOUT 150UL        ///< Max wait (ms) for the command acknowledge
+#define PLAYER_RETRIES 2                ///< Max number of times a command is sent again
 
 #define ANALOG_FADE_PIN 0               ///< Analog port to read the max value for the fade in/out
-#define FADE_IN 1                       ///< Volume fade in direction
-#define FADE_OUT -1                     ///< Volume fade out direction
+#define VOLUME_OVERSAMPLE 4             ///< Volume knob reads averaged in a sample
+#define VOLUME_FILTER_SHIFT 3           ///< Volume knob moving average weight, 1/8 every new sample
+#define VOLUME_HYSTERESIS 8             ///< Min volume knob change (ADC units) changing the volume
+#define VOLUME_SAMPLE_TIME 20UL         ///< Volume knob sampling interval (ms)
+
+#define FADE_LINEAR 0       ///< Constant speed fade
+#define FADE_SMOOTH 1       ///< Fade starting and ending slowly
+#define FADE_EASE_IN 2      ///< Fade starting slowly
+#define FADE_EASE_OUT 3     ///< Fade ending slowly
+#define FADE_ONE 1024L      ///< Fixed point unit of the fade position
+
+/**
+ * Min time (ms) between two volume commands. A command frame takes about
+ * 10 ms at 9600 baud, the slot leaves the player the time to process it
+ */
+#define VOLUME_SLOT 40
+#define FADE_IN_TIME 4000UL             ///< Duration of the song fade in (ms)
+#define FADE_OUT_TIME 3000UL            ///< Duration of the song fade out (ms)
+#define FADE_DYNAMIC_TIME 1000UL        ///< Duration of the fade to a new max volume (ms)
+#define FADE_IN_CURVE FADE_EASE_IN      ///< Curve of the song fade in
+#define FADE_OUT_CURVE FADE_EASE_OUT    ///< Curve of the song fade out
+
+//! Player command or event
+typedef struct {
+  byte cmd;                         ///< Command or event ID
+  unsigned int param;               ///< Command or event parameter
+} PlayerCommand;
+
+//! A track of the playlist
+typedef struct {
+  byte folder;                      ///< Folder number, 0 for the root folder
+  byte file;                        ///< File number in the folder
+  unsigned long duration;           ///< Track length (ms), 0 if unknown
+  byte weight;                      ///< Plays in a round of the shuffled playlist
+} TrackInfo;
 
 /**
  * Sound control parameters and flags to manage the different playing states
@@ -39,8 +131,11 @@ typedef struct {
   int currentSong = 0;              ///< The song that is playing or the last played, initially no song
   int volume = START_VOLUME;        ///< The current playing volume
   int maxVolume = START_VOLUME;    ///< The duynamic max volume level
+  int linkVolume = 0;               ///< Max volume set on the serial link, 0 to use the trimmer
+  boolean isLinked = false;         ///< The carousel board was connected at the last check
   boolean trigger = false;          ///< The trigger status
   boolean isPlaying = false;      ///< Current playing status (condition the trigger behavior)
+  boolean isFadingOut = false;    ///< The song is fading out, it will be paused at the end of the fade
 } SoundControl;
 
  #endif
@@ -0,0 +1,202 @@
+/**
+ * \file player.cpp
+ * \brief Asynchronous DFPlayer mini command queue
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "player.h"
+
+PlayerQueue::PlayerQueue() {
+  serial = NULL;
+  head = 0;
+  count = 0;
+  inFlight = false;
+  attempts = 0;
+  timerSent = 0;
+  frameLen = 0;
+  eventReady = false;
+  failures = 0;
+}
+
+void PlayerQueue::begin(Stream &s) {
+  serial = &s;
+  head = 0;
+  count = 0;
+  inFlight = false;
+  frameLen = 0;
+  eventReady = false;
+}
+
+uint16_t PlayerQueue::checksum(byte *buffer) {
+  uint16_t sum = 0;
+  int j;
+
+  for(j = PLAYER_FRAME_VERSION; j <= PLAYER_FRAME_PARAM_L; j++) {
+    sum += buffer[j];
+  }
+  return 0 - sum;
+}
+
+boolean PlayerQueue::push(byte cmd, unsigned int param) {
+  int last;
+
+  if(count > 0) {
+    last = (head + count - 1) % PLAYER_QUEUE_SIZE;
+    if( (commands[last].cmd == cmd) && !((count == 1) && (inFlight == true)) ) {
+      // Replace the value not yet sent
+      commands[last].param = param;
+      return true;
+    }
+  }
+  if(count == PLAYER_QUEUE_SIZE) {
+    return false;
+  }
+  commands[(head + count) % PLAYER_QUEUE_SIZE].cmd = cmd;
+  commands[(head + count) % PLAYER_QUEUE_SIZE].param = param;
+  count++;
+  return true;
+}
+
+void PlayerQueue::send(unsigned long now) {
+  byte buffer[PLAYER_FRAME_LEN];
+  uint16_t sum;
+
+  buffer[PLAYER_FRAME_START] = PLAYER_START;
+  buffer[PLAYER_FRAME_VERSION] = PLAYER_VERSION;
+  buffer[PLAYER_FRAME_LENGTH] = PLAYER_LENGTH;
+  buffer[PLAYER_FRAME_CMD] = commands[head].cmd;
+  buffer[PLAYER_FRAME_ACK] = 1;
+  buffer[PLAYER_FRAME_PARAM_H] = highByte(commands[head].param);
+  buffer[PLAYER_FRAME_PARAM_L] = lowByte(commands[head].param);
+  sum = checksum(buffer);
+  buffer[PLAYER_FRAME_CHECK_H] = highByte(sum);
+  buffer[PLAYER_FRAME_CHECK_L] = lowByte(sum);
+  buffer[PLAYER_FRAME_END] = PLAYER_END;
+
+  serial->write(buffer, PLAYER_FRAME_LEN);
+  inFlight = true;
+  attempts++;
+  timerSent = now;
+}
+
+void PlayerQueue::done() {
+  head = (head + 1) % PLAYER_QUEUE_SIZE;
+  count--;
+  inFlight = false;
+  attempts = 0;
+}
+
+void PlayerQueue::receive(unsigned long now) {
+  unsigned int param;
+
+  if( (frame[PLAYER_FRAME_END] != PLAYER_END) ||
+      (word(frame[PLAYER_FRAME_CHECK_H], frame[PLAYER_FRAME_CHECK_L]) != checksum(frame)) ) {
+    // Corrupted frame
+    return;
+  }
+
+  param = word(frame[PLAYER_FRAME_PARAM_H], frame[PLAYER_FRAME_PARAM_L]);
+  switch(frame[PLAYER_FRAME_CMD]) {
+    case PLAYER_EVT_ACK:
+      if(inFlight == true) {
+        done();
+      }
+      break;
+    case PLAYER_EVT_ERROR:
+      if(inFlight == true) {
+        // Send it again at the next update
+        timerSent = now - PLAYER_ACK_TIMEOUT;
+      }
+      break;
+    default:
+      // Notification from the player
+      event.cmd = frame[PLAYER_FRAME_CMD];
+      event.param = param;
+      eventReady = true;
+      break;
+  }
+}
+
+void PlayerQueue::update(unsigned long now) {
+  byte b;
+
+  if(serial == NULL) {
+    return;
+  }
+
+  // Collect the answers of the player
+  while(serial->available() > 0) {
+    b = serial->read();
+    if( (frameLen == PLAYER_FRAME_START) && (b != PLAYER_START) ) {
+      // Wait for the start of a frame
+      continue;
+    }
+    frame[frameLen++] = b;
+    if(frameLen == PLAYER_FRAME_LEN) {
+      receive(now);
+      frameLen = 0;
+    }
+  } // Serial data
+
+  if( (inFlight == true) && ((now - timerSent) >= PLAYER_ACK_TIMEOUT) ) {
+    if(attempts > PLAYER_RETRIES) {
+      // The player does not accept it, go on with the next one
+      failures++;
+      done();
+    } else {
+      inFlight = false;
+    }
+  } // Command timeout
+
+  if( (inFlight == false) && (count > 0) ) {
+    send(now);
+  }
+}
+
+boolean PlayerQueue::readEvent(byte &cmd, unsigned int &param) {
+  if(eventReady == false) {
+    return false;
+  }
+  cmd = event.cmd;
+  param = event.param;
+  eventReady = false;
+  return true;
+}
+
+boolean PlayerQueue::isIdle() {
+  return (count == 0);
+}
+
+unsigned int PlayerQueue::getFailures() {
+  return failures;
+}
+
+boolean PlayerQueue::volume(int v) {
+  return push(PLAYER_CMD_VOLUME, constrain(v, 0, PLAYER_MAX_VOLUME));
+}
+
+boolean PlayerQueue::EQ(int eq) {
+  return push(PLAYER_CMD_EQ, eq);
+}
+
+boolean PlayerQueue::outputDevice(int device) {
+  return push(PLAYER_CMD_DEVICE, device);
+}
+
+boolean PlayerQueue::play(int folder, int file) {
+  if(folder == 0) {
+    return push(PLAYER_CMD_PLAY, file);
+  }
+  return push(PLAYER_CMD_FOLDER, word(folder, file));
+}
+
+boolean PlayerQueue::pause() {
+  return push(PLAYER_CMD_PAUSE, 0);
+}
+
+boolean PlayerQueue::start() {
+  return push(PLAYER_CMD_START, 0);
+}
@@ -0,0 +1,147 @@
+/**
+ * \file player.h
+ * \brief Asynchronous DFPlayer mini command queue
+ * 
+ * The commands are queued and sent to the player one at a time, every
+ * command asking the player for the acknowledge. The next command is
+ * sent as soon as the acknowledge arrives; if the player answers with
+ * an error or does not answer within PLAYER_ACK_TIMEOUT the command is
+ * sent again, up to PLAYER_RETRIES times, then it is dropped. Nothing
+ * waits: the answers are read and the timeouts are checked by update(),
+ * called every loop.
+ * 
+ * The player frame is 10 bytes:
+ * 0x7E 0xFF 0x06 CMD ACK PARAM_H PARAM_L CHECKSUM_H CHECKSUM_L 0xEF
+ * where the checksum is the two's complement of the sum of the bytes from
+ * the version (0xFF) to PARAM_L.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _PLAYER
+#define _PLAYER
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! DFPlayer mini asynchronous command queue
+class PlayerQueue {
+  private:
+  //! Serial connected to the player
+  Stream *serial;
+  //! Circular buffer of the commands waiting to be sent
+  PlayerCommand commands[PLAYER_QUEUE_SIZE];
+  //! Index of the first command, the one in flight if any
+  int head;
+  //! Number of queued commands
+  int count;
+  //! True if the first command has been sent and waits for the acknowledge
+  boolean inFlight;
+  //! Number of times the command in flight has been sent
+  int attempts;
+  //! Time (ms) the command in flight has been sent
+  unsigned long timerSent;
+  //! Incoming frame
+  byte frame[PLAYER_FRAME_LEN];
+  //! Number of bytes of the incoming frame received
+  int frameLen;
+  //! Last event notified by the player
+  PlayerCommand event;
+  //! True if the last event has not been read
+  boolean eventReady;
+  //! Number of commands dropped after the last retry
+  unsigned int failures;
+
+  /**
+   * Calculate the frame checksum
+   * 
+   * @param buffer The frame
+   */
+  uint16_t checksum(byte *buffer);
+
+  /**
+   * Send the first command of the queue
+   * 
+   * @param now The current time (ms)
+   */
+  void send(unsigned long now);
+
+  /**
+   * Remove the command in flight from the queue
+   */
+  void done();
+
+  /**
+   * Process a complete frame received from the player
+   * 
+   * @param now The current time (ms)
+   */
+  void receive(unsigned long now);
+
+  public:
+  PlayerQueue();
+
+  /**
+   * Set the serial connected to the player and empty the queue
+   * 
+   * @param s The serial, already initialized at SERIAL_SPEED
+   */
+  void begin(Stream &s);
+
+  /**
+   * Queue a command. If the last queued command, not yet sent, has the
+   * same ID its parameter is replaced, so a stale value is never sent
+   * 
+   * @param cmd The command ID (PLAYER_CMD_xxx)
+   * @param param The command parameter
+   * @return false if the queue is full
+   */
+  boolean push(byte cmd, unsigned int param);
+
+  /**
+   * Read the player answers, check the timeout of the command in flight
+   * and send the next command
+   * 
+   * @param now The current time (ms)
+   */
+  void update(unsigned long now);
+
+  /**
+   * Read the last event notified by the player (track finished, player
+   * online, ...)
+   * 
+   * @param cmd The event ID (PLAYER_EVT_xxx)
+   * @param param The event parameter
+   * @return false if there are no new events
+   */
+  boolean readEvent(byte &cmd, unsigned int &param);
+
+  /**
+   * Return true if all the commands have been sent and acknowledged
+   */
+  boolean isIdle();
+
+  /**
+   * Get the number of commands dropped after the last retry
+   */
+  unsigned int getFailures();
+
+  // ========================================== Player commands
+
+  //! Set the volume (0-30)
+  boolean volume(int v);
+  //! Set the equalization
+  boolean EQ(int eq);
+  //! Set the playing device
+  boolean outputDevice(int device);
+  //! Play a file of a folder, folder 0 for the root folder
+  boolean play(int folder, int file);
+  //! Pause the playing track
+  boolean pause();
+  //! Resume the paused track
+  boolean start();
+};
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * \file playlist.cpp
+ * \brief Soundtrack playlist engine
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "playlist.h"
+#include "tracks.h"
+#include <EEPROM.h>
+
+void Playlist::begin(boolean random) {
+  shuffle = random;
+  current = -1;
+  started = false;
+  pending = false;
+  playing = false;
+  measured = false;
+  timerStart = 0;
+  noteStart = 0;
+  duration = 0;
+  seek = 0;
+  ended = -1;
+  upcoming = -1;
+  loadLengths();
+  newRound();
+}
+
+void Playlist::loadLengths() {
+  int j;
+
+  if( (EEPROM.read(PLAYLIST_EEPROM_ADDRESS) == PLAYLIST_EEPROM_MAGIC) &&
+      (EEPROM.read(PLAYLIST_EEPROM_ADDRESS + 1) == NUMTRACKS) ) {
+    EEPROM.get(PLAYLIST_EEPROM_ADDRESS + 2, lengths);
+    return;
+  }
+  // Blank EEPROM or another card: all the lengths should be measured
+  for(j = 0; j < NUMTRACKS; j++) {
+    lengths[j] = 0;
+  }
+  EEPROM.put(PLAYLIST_EEPROM_ADDRESS + 2, lengths);
+  EEPROM.update(PLAYLIST_EEPROM_ADDRESS + 1, NUMTRACKS);
+  EEPROM.update(PLAYLIST_EEPROM_ADDRESS, PLAYLIST_EEPROM_MAGIC);
+}
+
+void Playlist::saveLength(int j, unsigned long ms) {
+  if(lengths[j] != ms) {
+    lengths[j] = ms;
+    EEPROM.put(PLAYLIST_EEPROM_ADDRESS + 2 + j * sizeof(unsigned long), ms);
+  }
+}
+
+void Playlist::newRound() {
+  int j;
+
+  roundLeft = 0;
+  for(j = 0; j < NUMTRACKS; j++) {
+    playsLeft[j] = pgm_read_byte(&playlistTracks[j].weight);
+    roundLeft += playsLeft[j];
+  }
+}
+
+int Playlist::pickRandom() {
+  int j;
+  int exclude = -1;
+  int total = roundLeft;
+  long r;
+
+  // Never the same track twice in a row, if there are others
+  if( (current >= 0) && (playsLeft[current] < total) ) {
+    exclude = current;
+    total -= playsLeft[current];
+  }
+
+  r = random(total);
+  for(j = 0; j < NUMTRACKS; j++) {
+    if(j == exclude) {
+      continue;
+    }
+    if(r < playsLeft[j]) {
+      break;
+    }
+    r -= playsLeft[j];
+  }
+  playsLeft[j]--;
+  roundLeft--;
+  return j;
+}
+
+int Playlist::pickNext() {
+  int j;
+  int k = current;
+
+  for(j = 0; j < NUMTRACKS; j++) {
+    k = (k + 1) % NUMTRACKS;
+    if(pgm_read_byte(&playlistTracks[k].weight) > 0) {
+      return k;
+    }
+  }
+  // All the tracks are disabled, play the first anyway
+  return 0;
+}
+
+int Playlist::choose() {
+  if(shuffle == true) {
+    if(roundLeft == 0) {
+      newRound();
+    }
+    // With all the weights 0 there is nothing to shuffle
+    if(roundLeft > 0) {
+      return pickRandom();
+    }
+  }
+  return pickNext();
+}
+
+int Playlist::next() {
+  int j = upcoming;
+
+  if(j < 0) {
+    j = choose();
+  }
+  upcoming = -1;
+  return j;
+}
+
+TrackInfo Playlist::getTrack(int j) {
+  TrackInfo t;
+
+  t.folder = pgm_read_byte(&playlistTracks[j].folder);
+  t.file = pgm_read_byte(&playlistTracks[j].file);
+  t.duration = pgm_read_dword(&playlistTracks[j].duration);
+  t.weight = pgm_read_byte(&playlistTracks[j].weight);
+  return t;
+}
+
+unsigned long Playlist::getLength(int j) {
+  unsigned long ms = pgm_read_dword(&playlistTracks[j].duration);
+
+  if(ms > 0) {
+    return ms;
+  }
+  return lengths[j];
+}
+
+void Playlist::start(int j, boolean next, unsigned long now) {
+  // Started before the end of the playing track: it plays as soon as the
+  // playing one ends
+  pending = (next == true) && (playing == true) && (started == true) && (duration > 0);
+  if(pending == true) {
+    noteStart += duration;
+  } else if(next == false) {
+    ended = -1;
+  }
+  // Just played on request
+  if(upcoming == j) {
+    upcoming = -1;
+  }
+  started = false;
+  current = j;
+  duration = getLength(j);
+  timerStart = now;
+}
+
+boolean Playlist::isTrackEnd(boolean idle, unsigned long now) {
+  if(current < 0) {
+    return false;
+  }
+  if(idle == false) {
+    playing = true;
+    if(pending == true) {
+      // The previous track is still playing
+      if((long)(now - noteStart) < 0) {
+        return false;
+      }
+      pending = false;
+      started = true;
+      measured = false;
+    } else if(started == false) {
+      started = true;
+      measured = true;
+      noteStart = now;
+      seek = now - timerStart;
+    }
+    // Known length: start the next track while this one is finishing. A
+    // next track of unknown length starts when this one ends instead, to
+    // be measured
+    if( (duration > seek + PLAYLIST_PREISSUE) &&
+        ((now - noteStart) >= duration - seek - PLAYLIST_PREISSUE) ) {
+      if(upcoming < 0) {
+        upcoming = choose();
+      }
+      return getLength(upcoming) > 0;
+    }
+    return false;
+  }
+  playing = false;
+  if(pending == true) {
+    // The previous track ended before the player had this one ready: it
+    // starts when the busy pin goes low, as a track not started before
+    pending = false;
+    return false;
+  }
+  if(started == true) {
+    // Played to the end: measure it, if not in the table
+    ended = -1;
+    if( (measured == true) && (pgm_read_dword(&playlistTracks[current].duration) == 0) ) {
+      ended = current;
+      endedLength = now - noteStart;
+    }
+    return true;
+  }
+  // The player is still seeking the track
+  return (now - timerStart) >= PLAYLIST_START_TIMEOUT;
+}
+
+void Playlist::finished() {
+  if(ended >= 0) {
+    saveLength(ended, endedLength);
+    ended = -1;
+  }
+}
+
+int Playlist::getCurrent() {
+  return current;
+}
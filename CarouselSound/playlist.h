@@ -0,0 +1,175 @@
+/**
+ * \file playlist.h
+ * \brief Soundtrack playlist engine
+ * 
+ * Chooses the tracks of the table in tracks.h and detects their end.
+ * 
+ * In shuffle mode every track is played as many times as its weight in
+ * a round, in random order, and a round never starts with the track that
+ * ended the previous one. Otherwise the tracks are played in the table
+ * order, skipping the ones with weight 0.
+ * 
+ * The next track is started before the end of the playing one, so the
+ * player seeks it while the current one is finishing and there is no
+ * silence between them: the play is sent as long before the end as the
+ * player took to start the last track, plus PLAYLIST_PREISSUE ms. The
+ * length of the tracks is in the table; the tracks with length 0 are
+ * measured by the busy pin the first time they are played to the end, as
+ * confirmed by the track finished event of the player (the busy pin goes
+ * high also when the player resets), and the lengths are kept in the EEPROM, so they are known from the next
+ * boot too. A track of unknown length is not started before the end of
+ * the previous one, to be measured. Change PLAYLIST_EEPROM_MAGIC when the files on the card change
+ * to measure them again.
+ * 
+ * The busy pin also ends the tracks of unknown length: the track has ended
+ * when the pin goes back high after it has been low. The play command can
+ * wait in the player queue and be sent again, so there is no fixed time
+ * the pin should go low; if it does not within PLAYLIST_START_TIMEOUT ms
+ * the track is skipped (e.g. a missing file).
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _PLAYLIST
+#define _PLAYLIST
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Soundtrack playlist
+class Playlist {
+  private:
+  //! Plays left in the current round, by track
+  byte playsLeft[NUMTRACKS];
+  //! Total plays left in the current round
+  int roundLeft;
+  //! Playing track index, -1 if none
+  int current;
+  //! True when the busy pin has shown the playing track started
+  boolean started;
+  //! True when the playing track has been started before the end of the
+  //! previous one, that is still playing
+  boolean pending;
+  //! True when the busy pin was low at the last check
+  boolean playing;
+  //! True when the busy pin has shown the time the playing track started,
+  //! not the case of a track started before the end of the previous one
+  boolean measured;
+  //! Time (ms) the play of the playing track has been sent
+  unsigned long timerStart;
+  //! Time (ms) the playing track started, or it is expected to start
+  unsigned long noteStart;
+  //! Length (ms) of the playing track, 0 if unknown
+  unsigned long duration;
+  //! Time (ms) the player took to start the last track
+  unsigned long seek;
+  //! Track lengths (ms) measured, 0 if not yet
+  unsigned long lengths[NUMTRACKS];
+  //! Track index that the busy pin has shown ended, -1 if none
+  int ended;
+  //! Length (ms) of the track ended
+  unsigned long endedLength;
+  //! Next track index, chosen before the end of the playing one, -1 if
+  //! not yet
+  int upcoming;
+  //! True to shuffle the tracks
+  boolean shuffle;
+
+  /**
+   * Start a new round of the shuffled playlist
+   */
+  void newRound();
+
+  /**
+   * Pick a random track between the plays left in the round, that
+   * should not be empty
+   */
+  int pickRandom();
+
+  /**
+   * Pick the next track in the table order
+   */
+  int pickNext();
+
+  /**
+   * Choose a track in the playlist order
+   */
+  int choose();
+
+  /**
+   * Read the track lengths measured from the EEPROM, or initialize them
+   */
+  void loadLengths();
+
+  /**
+   * Keep the length of a track measured, also in the EEPROM
+   * 
+   * @param j The track index
+   * @param ms The track length (ms)
+   */
+  void saveLength(int j, unsigned long ms);
+
+  public:
+  /**
+   * Initialize the playlist
+   * 
+   * @param random True to shuffle the tracks
+   */
+  void begin(boolean random);
+
+  /**
+   * Choose the next track to play, or get the one already chosen before
+   * the end of the playing track
+   * 
+   * @return the track index in the table
+   */
+  int next();
+
+  /**
+   * Read a track from the table
+   * 
+   * @param j The track index
+   */
+  TrackInfo getTrack(int j);
+
+  /**
+   * Get the length of a track, from the table or measured
+   * 
+   * @param j The track index
+   * @return the length (ms), 0 if unknown
+   */
+  unsigned long getLength(int j);
+
+  /**
+   * Set the track that started playing
+   * 
+   * @param j The track index
+   * @param next True if the track follows the playing one, when
+   * isTrackEnd() has returned true
+   * @param now The current time (ms)
+   */
+  void start(int j, boolean next, unsigned long now);
+
+  /**
+   * Return true if it is time to start the next track
+   * 
+   * @param idle True if the player busy pin shows the player is not playing
+   * @param now The current time (ms)
+   */
+  boolean isTrackEnd(boolean idle, unsigned long now);
+
+  /**
+   * The player notified a track finished: the last track ended is kept
+   * with the length measured
+   */
+  void finished();
+
+  /**
+   * Get the playing track index, -1 if none
+   */
+  int getCurrent();
+};
+
+#endif
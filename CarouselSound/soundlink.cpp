@@ -0,0 +1,78 @@
+/**
+ * \file soundlink.cpp
+ * \brief Framed serial link between the carousel board and the sound board
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "soundlink.h"
+
+SoundLink::SoundLink() {
+  serial = NULL;
+  frameLen = 0;
+  timerReceived = 0;
+  received = false;
+  errors = 0;
+}
+
+void SoundLink::begin(Stream &s) {
+  serial = &s;
+  frameLen = 0;
+  received = false;
+}
+
+void SoundLink::send(byte cmd, unsigned int param) {
+  byte buffer[SOUND_LINK_FRAME_LEN];
+
+  if(serial == NULL) {
+    return;
+  }
+  buffer[0] = SOUND_LINK_START;
+  buffer[1] = cmd;
+  buffer[2] = highByte(param);
+  buffer[3] = lowByte(param);
+  buffer[4] = buffer[0] ^ buffer[1] ^ buffer[2] ^ buffer[3];
+  serial->write(buffer, SOUND_LINK_FRAME_LEN);
+}
+
+boolean SoundLink::read(LinkFrame &f, unsigned long now) {
+  byte b;
+
+  if(serial == NULL) {
+    return false;
+  }
+
+  while(serial->available() > 0) {
+    b = serial->read();
+    if( (frameLen == 0) && (b != SOUND_LINK_START) ) {
+      // Wait for the start of a frame
+      continue;
+    }
+    frame[frameLen++] = b;
+    if(frameLen == SOUND_LINK_FRAME_LEN) {
+      frameLen = 0;
+      if((frame[0] ^ frame[1] ^ frame[2] ^ frame[3]) != frame[4]) {
+        // Corrupted frame
+        errors++;
+        continue;
+      }
+      f.cmd = frame[1];
+      f.param = word(frame[2], frame[3]);
+      timerReceived = now;
+      received = true;
+      return true;
+    } // Complete frame
+  } // Serial data
+
+  return false;
+}
+
+boolean SoundLink::isConnected(unsigned long now) {
+  return (received == true) && ((now - timerReceived) < SOUND_LINK_TIMEOUT);
+}
+
+unsigned int SoundLink::getErrors() {
+  return errors;
+}
@@ -0,0 +1,47 @@
+/**
+ * \file tracks.h
+ * \brief Soundtrack table, stored in flash
+ * 
+ * Every track is a file in a folder of the microSD card: the files of the
+ * folders 01 .. 99 are named 001.mp3 .. 255.mp3; the folder 0 means the
+ * files in the root folder, numbered by the player in their copy order.
+ * 
+ * The duration is the length (ms) of the recording: the next track is
+ * started before the end, so the player seeks it while the current one
+ * is finishing. With duration 0 the length is measured by the playlist the
+ * first time the track is played to the end, and kept in the EEPROM (see
+ * playlist.h).
+ * 
+ * The weight is the number of times the track is played in a round of
+ * the shuffled playlist; a track with weight 0 is never played.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _TRACKS
+#define _TRACKS
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Soundtrack pieces, by track number - 1
+const TrackInfo playlistTracks[NUMTRACKS] PROGMEM = {
+  // folder, file, duration (ms), weight
+  { 0, 1, 0, 1 },
+  { 0, 2, 0, 1 },
+  { 0, 3, 0, 1 },
+  { 0, 4, 0, 1 },
+  { 0, 5, 0, 1 },
+  { 0, 6, 0, 1 },
+  { 0, 7, 0, 1 },
+  { 0, 8, 0, 1 },
+  { 0, 9, 0, 1 },
+  { 0, 10, 0, 1 },
+  { 0, 11, 0, 1 },
+  { 0, 12, 0, 1 },
+  { 0, 13, 0, 1 }
+};
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * \file volume.cpp
+ * \brief Time based player volume fade engine
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "volume.h"
+
+VolumeFader::VolumeFader() {
+  begin(START_VOLUME, 0);
+}
+
+void VolumeFader::begin(int v, unsigned long now) {
+  startVolume = v;
+  targetVolume = v;
+  sentVolume = v;
+  timerStart = now;
+  duration = 0;
+  timerSlot = now;
+  curve = FADE_LINEAR;
+  running = false;
+}
+
+void VolumeFader::fadeTo(int target, unsigned long ms, int fadeCurve, unsigned long now) {
+  if(target == targetVolume) {
+    // Already going there
+    return;
+  }
+  // Restart from the volume the player is playing now
+  startVolume = sentVolume;
+  targetVolume = target;
+  timerStart = now;
+  duration = ms;
+  curve = fadeCurve;
+  running = true;
+}
+
+void VolumeFader::commandSent(unsigned long now) {
+  timerSlot = now;
+}
+
+int VolumeFader::getFadeVolume(unsigned long now) {
+  unsigned long elapsed;
+  long t;
+
+  elapsed = now - timerStart;
+  if(elapsed >= duration) {
+    return targetVolume;
+  }
+
+  // Fixed point fade position, from 0 to FADE_ONE
+  t = long(elapsed * FADE_ONE / duration);
+  switch(curve) {
+    case FADE_SMOOTH:
+      // Smoothstep 3t^2 - 2t^3
+      t = t * t / FADE_ONE * (3 * FADE_ONE - 2 * t) / FADE_ONE;
+      break;
+    case FADE_EASE_IN:
+      t = t * t / FADE_ONE;
+      break;
+    case FADE_EASE_OUT:
+      t = FADE_ONE - (FADE_ONE - t) * (FADE_ONE - t) / FADE_ONE;
+      break;
+  }
+  return startVolume + int(long(targetVolume - startVolume) * t / FADE_ONE);
+}
+
+int VolumeFader::update(unsigned long now) {
+  int v;
+
+  if( (running == false) || ((now - timerSlot) < VOLUME_SLOT) ) {
+    // Nothing to do or the player serial is still busy
+    return -1;
+  }
+
+  v = getFadeVolume(now);
+  if(v == targetVolume) {
+    running = false;
+  }
+  if(v == sentVolume) {
+    // The volume has not changed since the last command
+    return -1;
+  }
+
+  sentVolume = v;
+  timerSlot = now;
+  return v;
+}
+
+int VolumeFader::getVolume() {
+  return sentVolume;
+}
+
+int VolumeFader::getTarget() {
+  return targetVolume;
+}
+
+boolean VolumeFader::isRunning() {
+  return running;
+}
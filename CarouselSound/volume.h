@@ -0,0 +1,110 @@
+/**
+ * \file volume.h
+ * \brief Time based player volume fade engine
+ * 
+ * The volume moves from its current level to a target level in a given
+ * time, calculated from the elapsed time every time update() is called.
+ * The player serial is slow (a 10 bytes frame at 9600 baud) so the engine
+ * sends at most one volume command every VOLUME_SLOT ms: when the slot is
+ * free the volume of that moment is sent and the intermediate values
+ * already passed are dropped. A new target can be set at any time, also
+ * in the middle of a fade; the new fade starts from the current volume.
+ * 
+ * The fade shape depends on the curve:
+ * - FADE_LINEAR constant speed
+ * - FADE_SMOOTH starts and ends slowly (smoothstep curve)
+ * - FADE_EASE_IN starts slowly, better for the fade in
+ * - FADE_EASE_OUT ends slowly, better for the fade out
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _VOLUME
+#define _VOLUME
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Player volume fade engine
+class VolumeFader {
+  private:
+  //! Volume when the fade started
+  int startVolume;
+  //! Volume at the end of the fade
+  int targetVolume;
+  //! Last volume sent to the player
+  int sentVolume;
+  //! Time (ms) the fade started
+  unsigned long timerStart;
+  //! Fade duration (ms)
+  unsigned long duration;
+  //! Time (ms) of the last command sent to the player
+  unsigned long timerSlot;
+  //! Fade curve ID
+  int curve;
+  //! True until the target volume has not been sent
+  boolean running;
+
+  /**
+   * Calculate the volume of the fade at the current time
+   * 
+   * @param now The current time (ms)
+   */
+  int getFadeVolume(unsigned long now);
+
+  public:
+  VolumeFader();
+
+  /**
+   * Set the volume already set on the player, stopping the fade
+   * 
+   * @param v The player volume
+   * @param now The current time (ms)
+   */
+  void begin(int v, unsigned long now);
+
+  /**
+   * Start a new fade from the current volume
+   * 
+   * @param target The volume to reach
+   * @param ms The fade duration (ms), 0 to jump to the target
+   * @param fadeCurve The curve ID (FADE_xxx)
+   * @param now The current time (ms)
+   */
+  void fadeTo(int target, unsigned long ms, int fadeCurve, unsigned long now);
+
+  /**
+   * Book the player serial for another command, so the next volume
+   * command waits for a free slot
+   * 
+   * @param now The current time (ms)
+   */
+  void commandSent(unsigned long now);
+
+  /**
+   * Check if a new volume should be sent to the player
+   * 
+   * @param now The current time (ms)
+   * @return the volume to send or -1 if there is nothing to send now
+   */
+  int update(unsigned long now);
+
+  /**
+   * Get the last volume sent to the player
+   */
+  int getVolume();
+
+  /**
+   * Get the volume at the end of the fade
+   */
+  int getTarget();
+
+  /**
+   * Return true if the target volume has not been sent
+   */
+  boolean isRunning();
+};
+
+#endif
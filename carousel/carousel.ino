@@ -11,13 +11,18 @@
  * \version 1.0
  * 
  */
-#include "statemachine.h"
+#include "config.h"
+
+#include <statemachine.h>
 
 // Create an instance of the state machine class
 StateMachine carousel;
 
 //! Setup and initialization
 void setup() {
+#ifdef _DEBUG
+  Serial.begin(9600);
+#endif
   carousel.initHardware();
   carousel.initStatus();
 }
@@ -26,8 +31,8 @@ void setup() {
 void loop() {
   if(carousel.isPir() ) {
     // Sensor PIR has been activated, check if
-    // it is time to disable it
-    if(carousel.getElapsed() > CAROUSEL_CYCLE) {
+    // it is time to disable it: nobody around or max duration
+    if(carousel.isCycleEnd()) {
       // The cycle should stop
       carousel.endCarousel();
     } // Time elapsed
@@ -42,4 +47,7 @@ void loop() {
   // Update the hardware components, accordingly with 
   // the machine status
   carousel.updateHardware();
+
+  // Sleep while nothing is running
+  carousel.idle();
 }
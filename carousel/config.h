@@ -0,0 +1,24 @@
+/**
+ * \file config.h
+ * \brief Configuration of the carousel sketch
+ * 
+ * The carousel core (state machine, outputs, ramps, faders etc.) is the
+ * CarouselCore library in libraries/, shared by all the sketches. This file
+ * selects the features compiled in this sketch.
+ * 
+ * \date May 2019
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * 
+ */
+
+#ifndef _CONFIG
+#define _CONFIG
+
+// Define to enable the serial output of debug
+#undef _DEBUG
+
+// Define to add the loop timing instrumentation
+#undef _PROFILE
+
+#endif
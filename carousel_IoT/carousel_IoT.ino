@@ -16,10 +16,18 @@
 #include <ArduinoMqttClient.h>
 #include <WiFi101.h>
 
-#include "globals.h"
+#include "config.h"
 #include "carouselsecrets.h"
-#include "statemachine.h"
-#include "structs.h"
+
+#include <statemachine.h>
+#include <structs.h>
+#include <protocol.h>
+#include <jsonwriter.h>
+#include <telemetry.h>
+#include <bufferprint.h>
+#include <connection.h>
+#include <flashlog.h>
+#include <accounting.h>
 
 #ifdef _DEBUG
 #include "Streaming.h"
@@ -40,8 +48,46 @@ MqttClient mqttClient(sslClient);
 //! Create an instance of the state machine class
 StateMachine carousel;
 
-//! Status message struct
-IoTmessage statusIoT;
+//! Usage counters of the status message
+Accounting usage;
+
+//! Lifetime counters saved in flash, they survive the power cycles
+FlashLog statusLog;
+
+//! WiFi and MQTT broker connection manager
+ConnectionManager connection;
+
+//! Telemetry sampler
+Telemetry telemetry;
+
+//! Telemetry message buffer
+char telemetryBuffer[TELEMETRY_BUFFER_SIZE];
+
+#ifdef _PROFILE
+//! Loop profiler
+Profiler profiler;
+//! Time (ms) of the last instrumentation report
+unsigned long timerProfile;
+//! Instrumentation report message buffer
+char profileBuffer[PROFILE_BUFFER_SIZE];
+#endif
+
+// Function prototypes. They are usually generated by the Arduino IDE,
+// declaring them here the sketch also builds as plain C++
+unsigned long getTime();
+boolean connectWiFi();
+boolean isWiFiConnected();
+boolean connectMQTT();
+boolean isMQTTConnected();
+boolean subscribeMQTT();
+void onMessageReceived(int messageSize);
+void initIoTStatus();
+void updateIoTStatus();
+void publishJsonIoTStatus();
+boolean publishBuffer(const char* topic, BufferPrint &message);
+void publishTelemetry();
+void writePowerStats(JsonWriter &json);
+void publishProfile();
 
 //! Setup and initialization
 void setup() {
@@ -51,6 +97,9 @@ void setup() {
 
   carousel.initHardware();
   carousel.initStatus();
+  PROFILE_ATTACH(carousel);
+  initIoTStatus();
+  telemetry.begin(millis());
 
   if (!ECCX08.begin()) {
 #ifdef _DEBUG
@@ -78,27 +127,45 @@ void setup() {
   // Set the message callback, this function is
   // called when the MQTTClient receives a message
   mqttClient.onMessage(onMessageReceived);
+
+  // WiFi.begin() only starts the connection, the connection manager polls it
+  WiFi.setTimeout(0);
+  // Limit the time a broker connection attempt blocks the loop
+  mqttClient.setConnectionTimeout(MQTT_CONNECT_TIMEOUT);
+  connection.begin(connectWiFi, isWiFiConnected, connectMQTT, isMQTTConnected,
+                   subscribeMQTT, millis());
 } // Setup
 
 //! Main loop method
 void loop() {
-  // Always check if the WiFi is connected
-  if (WiFi.status() != WL_CONNECTED) {
-    connectWiFi();
-  }
-  // ... as well as the MQTT brokcer
-  if (!mqttClient.connected()) {
-    // MQTT client is disconnected, connect
-    connectMQTT();
-  }
+  unsigned long loopStart = micros();
+
+  PROFILE_LOOP();
+
+  // Check the WiFi and the MQTT broker connection. If the connection
+  // is lost the reconnection attempts are done in the next loop cycles,
+  // while the carousel continues to work with the PIR sensor. The broker
+  // connection blocks the loop, it is attempted only while nothing runs
+  connection.update(millis(), carousel.isIdle());
 
   // poll for new MQTT messages and send keep alives
-  mqttClient.poll();
-  
+  PROFILE_BEGIN(PHASE_POLL);
+  if(connection.isConnected()) {
+    mqttClient.poll();
+  }
+  PROFILE_END(PHASE_POLL);
+
+  // If a remote command has been sent, ignore the local process
+  // and process it then continue normally
+  PROFILE_BEGIN(PHASE_MQTT);
+  carousel.mqttCheckStatus();
+  PROFILE_END(PHASE_MQTT);
+
+  PROFILE_BEGIN(PHASE_PIR);
   if(carousel.isPir() ) {
     // Sensor PIR has been activated, check if
-    // it is time to disable it
-    if(carousel.getElapsed() > CAROUSEL_CYCLE) {
+    // it is time to disable it: nobody around or max duration
+    if(carousel.isCycleEnd()) {
       // The cycle should stop
       carousel.endCarousel();
       // Update hte IoT status
@@ -108,18 +175,39 @@ void loop() {
   else {
     // Check if there is a movement detection
     carousel.checkPirStatus();
-    // If Pir status is true, the music is starting and we shoud
-    // start the other stuff
-    if(carousel.isPir()) {
-      // If the carousel started, take into account of the current time
-      // to calulate the total playing time
-      statusIoT.timerStart = millis();
-    }
   } // Movement detection
+  PROFILE_END(PHASE_PIR);
 
   // Update the hardware components, accordingly with 
   // the machine status
+  PROFILE_BEGIN(PHASE_HARDWARE);
   carousel.updateHardware();
+  PROFILE_END(PHASE_HARDWARE);
+
+  // Count the wheel rotations at the speed commanded to the servo
+  usage.update(carousel.getWheel(), carousel.isPir(), millis());
+
+  // Sample the machine status and publish the changes
+  telemetry.update(carousel, millis());
+  if( (connection.isConnected()) && (telemetry.isPublishDue(millis())) ) {
+    publishTelemetry();
+  }
+
+#ifdef _PROFILE
+  // Report the loop timing
+  if( (connection.isConnected()) && ((millis() - timerProfile) >= PROFILE_DUMP_INTERVAL) ) {
+    timerProfile = millis();
+    publishProfile();
+  }
+#endif
+
+  // Loop duration, without the idle sleep counted in the power stats
+  PROFILE_LOOP_END();
+  telemetry.addLoop(micros() - loopStart);
+
+  // Sleep while nothing is running. The sleep is short enough
+  // to keep the broker connection alive
+  carousel.idle();
 } // Main loop
 
 // ======================================== IoT functions
@@ -131,56 +219,73 @@ void loop() {
       return WiFi.getTime();
   }
 
-//! Try to connect to the WiFi and retry after a delay if connection is not possible
-void connectWiFi() {
-#ifdef _DEBUG
-  Serial << "Attempting to connect to SSID: " << ssid << " ";
-#endif
+//! Start a connection to the WiFi, without waiting for it: the connection
+//! manager polls the WiFi status until WIFI_CONNECT_TIMEOUT and retries
+//! if it fails
+boolean connectWiFi() {
+  uint8_t status;
 
-  while (WiFi.begin(ssid, pass) != WL_CONNECTED) {
 #ifdef _DEBUG
-    Serial << ".";
-#endif
-    delay(CONN_DELAY);
-  }
-#ifdef _DEBUG
-  Serial << endl << "You're connected to the network" << endl;
+  Serial << "Attempting to connect to SSID: " << ssid << endl;
 #endif
+
+  status = WiFi.begin(ssid, pass);
+  return (status != WL_NO_SHIELD) && (status != WL_CONNECT_FAILED);
 }
 
-void connectMQTT() {
-#ifdef _DEBUG
-  Serial << "Attempting to MQTT broker: " << broker << " ";
-#endif
+//! Check the WiFi connection
+boolean isWiFiConnected() {
+  return WiFi.status() == WL_CONNECTED;
+}
 
-  while (!mqttClient.connect(broker, MQTT_BROKER_PORT)) {
-    // failed, retry
+//! Single attempt to connect to the MQTT broker, it blocks up to
+//! MQTT_CONNECT_TIMEOUT. The connection manager retries if it fails
+boolean connectMQTT() {
 #ifdef _DEBUG
-    Serial << ".";
+  Serial << "Attempting to MQTT broker: " << broker << endl;
 #endif
-    delay(CONN_DELAY);
-  }
 
+  return mqttClient.connect(broker, MQTT_BROKER_PORT);
+}
+
+//! Check the MQTT broker connection
+boolean isMQTTConnected() {
+  return mqttClient.connected();
+}
+
+//! Subscribe the topics when the connection is established
+boolean subscribeMQTT() {
 #ifdef _DEBUG
-  Serial << endl << "MQTT broker connection established" << endl;
+  Serial << "MQTT broker connection established" << endl;
 #endif
 
   // subscribe to a topic
-  mqttClient.subscribe(MQTT_CLIENT_SUBSCRIBER);
+  return mqttClient.subscribe(MQTT_CLIENT_SUBSCRIBER);
 }
 
 //! Message reeived callback function
 void onMessageReceived(int messageSize) {
+  //! The message payload, longer messages are not valid commands
+  static char bytes[CMD_MESSAGE_SIZE];
+  int length = 0;
+  MqttCommand cmd;
+
 #ifdef _DEBUG
   Serial << "Received a message '" << mqttClient.messageTopic() <<
   "', length " << messageSize << " bytes:" << endl;
 #endif
 
-  // use the Stream interface to print the contents
+  // use the Stream interface to read the contents
   while (mqttClient.available()) {
+    if(length < CMD_MESSAGE_SIZE) {
+      bytes[length] = (char)mqttClient.read();
 #ifdef _DEBUG
-    Serial << (char)mqttClient.read();
+      Serial << bytes[length];
 #endif
+      length++;
+    } else {
+      mqttClient.read();
+    }
   }
 
   // Empty the message buffer
@@ -190,52 +295,124 @@ void onMessageReceived(int messageSize) {
   Serial << endl << endl;
 #endif
 
+  // The status requests are not commands, only the valid commands
+  // are executed
+  if( (messageSize <= CMD_MESSAGE_SIZE) && (length > 0) && ((byte)bytes[0] == SHOW_FRAME_MAGIC) ) {
+    // New show, played by the show command
+    carousel.mqttLoadShow((const byte*)bytes, length);
+  } else if( (messageSize <= CMD_MESSAGE_SIZE) && parseCommand(bytes, length, cmd) ) {
+    if(cmd.id == MQTTCMD_SWEEP) {
+      // Sweep profiles are applied immediately
+      carousel.setSweepProfile(cmd.level);
+    } else {
+      // Queue the command to be executed
+      carousel.mqttSetCommand(cmd);
+    }
+  } // Command validated
+
   publishJsonIoTStatus();
 }
 
 // ======================================== IoT status functions
 
 //! Initialize the status structure on startu
+//! The counters restart from the last values saved in flash, if any
 void initIoTStatus() {
-  statusIoT.detections = 0;
-  statusIoT.timerStart = 0;
-  statusIoT.timePlayedUntilNow = 0;
-  statusIoT.wheelRotations = 0;
-  statusIoT.numSpheres = 0;  
+  usage.begin(millis());
+
+  if(statusLog.begin()) {
+    statusLog.read(&usage.getCounters(), sizeof(IoTmessage));
+  }
+#ifdef _DEBUG
+  Serial << "Lifetime counters restored, save #" << statusLog.getSequence() << endl;
+#endif
 }
 
 //! Update the status structure. Called when a cycle ends
-//! Note that the values of the status are updated in incremental
-//1 mode so every new update all the clues expresses the global
-//! sate of the carousel from the last startup
+//! The time played, the rotations and the spheres are integrated
+//! every loop cycle by the accounting, here the cycle is counted
+//! and the counters are saved
 void updateIoTStatus() {
-  //! The number of ms played by the last update
-  float msPlayed;
-  
-  // Increment the number of detections
-  statusIoT.detections++;
-  // Update the played minutes
-  msPlayed = millis() - statusIoT.timerStart;
-  // Conver the played ms in minutes and increment the played
-  //! minutes counter
-  statusIoT.timePlayedUntilNow += msPlayed / 60000;
-  //! Recalculate hte wheel rotations based on the RPM and the duration of a cycle
-  statusIoT.wheelRotations += msPlayed / 60000 * WHEEL_RPM;
-  //! Recalculate the number of spheres passed
-  statusIoT.numSpheres += statusIoT.wheelRotations * SPHERES_PER_ROTATION;
+  usage.cycleEnd();
+
+  // Save the counters once per cycle, when the carousel stops
+  if(!statusLog.append(&usage.getCounters(), sizeof(IoTmessage))) {
+#ifdef _DEBUG
+    Serial << "Lifetime counters not saved" << endl;
+#endif
+  }
 }
 
 //! Create the Json formatted IoT status message to send to the broker
-//! And publish MQTT
+//! And publish MQTT. The message is written directly to the MQTT client
+//! without temporary strings
 void publishJsonIoTStatus() {
-  String jPublish;
-  
-  // Create the message
-  jPublish = String("{\n'detections': " + String(statusIoT.detections) + 
-                    ",\n'minutes': " + String(statusIoT.timePlayedUntilNow) + 
-                    ",\nrotations': " + String(statusIoT.wheelRotations) + 
-                    ",\n'spheres': " + String(statusIoT.numSpheres) + "\n}");
+  JsonWriter json(mqttClient);
+
   mqttClient.beginMessage(MQTT_CLIENT_PUBLISHER);
-  mqttClient.print(jPublish);
+  json.beginObject();
+  json.add("detections", usage.getDetections());
+  json.add("minutes", usage.getMinutes());
+  json.add("rotations", usage.getRotations());
+  json.add("spheres", usage.getSpheres());
+  json.endObject();
   mqttClient.endMessage();
 }
+
+//! Publish a message prepared in a buffer. The size is sent with the
+//! topic, so the client streams the message instead of keeping only the
+//! first TX_PAYLOAD_BUFFER_SIZE bytes
+boolean publishBuffer(const char* topic, BufferPrint &message) {
+  // A truncated message is not valid Json, don't send it
+  if(message.isOverflow()) {
+    return false;
+  }
+  if(mqttClient.beginMessage(topic, (unsigned long)message.getLength()) == 0) {
+    return false;
+  }
+  mqttClient.write((const uint8_t*)message.getBuffer(), message.getLength());
+  return (mqttClient.endMessage() == 1);
+}
+
+//! Publish the telemetry samples waiting
+void publishTelemetry() {
+  BufferPrint message(telemetryBuffer, TELEMETRY_BUFFER_SIZE);
+  JsonWriter json(message);
+
+  json.beginObject();
+  json.add("id", MQTT_CLIENT_ID);
+  telemetry.write(json);
+  connection.write(json, "connection", millis());
+  writePowerStats(json);
+  json.endObject();
+  telemetry.published(publishBuffer(MQTT_CLIENT_TELEMETRY, message), millis());
+}
+
+//! Add the idle and sleep statistics to a Json message
+void writePowerStats(JsonWriter &json) {
+  PowerStats power = carousel.getPowerStats();
+
+  json.beginObject("power");
+  json.add("active", getActiveTime(power, millis()));
+  json.add("sleep", power.sleepTime);
+  json.add("sleeps", power.sleeps);
+  json.add("wakeups", power.wakeups);
+  json.add("wakeLatency", power.maxWakeLatency);
+  json.add("detaches", power.detaches);
+  json.endObject();
+}
+
+//! Report the loop timing statistics to the serial (debug) and
+//! to the broker, then start a new measure
+void publishProfile() {
+#ifdef _PROFILE
+  BufferPrint message(profileBuffer, PROFILE_BUFFER_SIZE);
+
+#ifdef _DEBUG
+  profiler.dump(Serial);
+#endif
+  profiler.dump(message);
+  publishBuffer(MQTT_CLIENT_PROFILE, message);
+  profiler.reset();
+#endif
+}
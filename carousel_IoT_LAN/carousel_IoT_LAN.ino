@@ -20,10 +20,15 @@
 #include <MQTT.h>
 #include <WiFi101.h>
 
-#include "globals.h"
+#include "config.h"
 #include "carouselsecrets.h"
-#include "statemachine.h"
-#include "structs.h"
+
+#include <statemachine.h>
+#include <structs.h>
+#include <protocol.h>
+#include <telemetry.h>
+#include <bufferprint.h>
+#include <connection.h>
 
 #ifdef _DEBUG
 #include "Streaming.h"
@@ -41,11 +46,41 @@ const char device[] = " ";  ///< No device in LAN (see key not)
 //! WiFi client used for the LAN connection
 WiFiClient wifiClient;
 //! MQTT client to connect the protocol to the broker
-MQTTClient mqttClient;
+MQTTClient mqttClient(MQTT_BUFFER_SIZE);
 
 //! Create an instance of the state machine class
 StateMachine carousel;
 
+//! WiFi and MQTT broker connection manager
+ConnectionManager connection;
+
+//! Telemetry sampler
+Telemetry telemetry;
+
+//! Telemetry message buffer
+char telemetryBuffer[TELEMETRY_BUFFER_SIZE];
+
+#ifdef _PROFILE
+//! Loop profiler
+Profiler profiler;
+//! Time (ms) of the last instrumentation report
+unsigned long timerProfile;
+//! Instrumentation report message buffer
+char profileBuffer[PROFILE_BUFFER_SIZE];
+#endif
+
+// Function prototypes. They are usually generated by the Arduino IDE,
+// declaring them here the sketch also builds as plain C++
+boolean connectWiFi();
+boolean isWiFiConnected();
+boolean connectMQTT();
+boolean isMQTTConnected();
+boolean subscribeMQTT();
+void onMessageReceived(MQTTClient *client, char topic[], char bytes[], int length);
+void publishTelemetry();
+void writePowerStats(JsonWriter &json);
+void publishProfile();
+
 //! Setup and initialization
 void setup() {
 #ifdef _DEBUG
@@ -53,31 +88,66 @@ void setup() {
 #endif
   carousel.initHardware();
   carousel.initStatus();
+  PROFILE_ATTACH(carousel);
+  telemetry.begin(millis());
+
+  //! Set the internal fixed IP address of the MKR100 board
+  IPAddress ip(192, 168, 0, 250);
+
+  // Configure the WiFi to a fixed IP address
+  WiFi.config(ip);
+  // WiFi.begin() only starts the connection, the connection manager polls it
+  WiFi.setTimeout(0);
+
+  //! Start the client on the local LAN
+  mqttClient.begin(mqttServer, MQTT_BROKER_PORT, wifiClient);
+  // Acrtivate the message callback. The advanced callback gives access
+  // to the receive buffer without creating String objects
+  mqttClient.onMessageAdvanced(onMessageReceived);
+
+  // Limit the time a broker connection attempt blocks the loop
+  mqttClient.setTimeout(MQTT_CONNECT_TIMEOUT);
+  connection.begin(connectWiFi, isWiFiConnected, connectMQTT, isMQTTConnected,
+                   subscribeMQTT, millis());
 } // Setup
 
 //! Main loop method
 void loop() {
-  // Always check if the WiFi is connected
-  // and eventually reconnect
-  if (WiFi.status() != WL_CONNECTED) {
-    connectWiFi();
-  }
-  // ... as well as the MQTT brokcer
-  if (!mqttClient.connected()) {
-    // MQTT client is disconnected, connect
-    connectMQTT();
+  unsigned long loopStart = micros();
+
+  PROFILE_LOOP();
+
+  // Check the WiFi and the MQTT broker connection. If the connection
+  // is lost the reconnection attempts are done in the next loop cycles,
+  // while the carousel continues to work with the PIR sensor. The broker
+  // connection blocks the loop, it is attempted only while nothing runs
+  connection.update(millis(), carousel.isIdle());
+
+  // Process the incoming messages and keep the broker connection alive
+  PROFILE_BEGIN(PHASE_POLL);
+  if(connection.isConnected()) {
+    mqttClient.loop();
   }
+  PROFILE_END(PHASE_POLL);
 
   // If a remote command has been sent, ignore the local process
-  // and process it then continue normally
+  // and process it then continue normally. The command sequence
+  // doesn't block the loop, it is advanced by updateHardware()
+  PROFILE_BEGIN(PHASE_MQTT);
   carousel.mqttCheckStatus();
-  
+  PROFILE_END(PHASE_MQTT);
+
+  PROFILE_BEGIN(PHASE_PIR);
   if(carousel.isPir() ) {
     // Sensor PIR has been activated, check if
-    // it is time to disable it
-    if(carousel.getElapsed() > CAROUSEL_CYCLE) {
+    // it is time to disable it: nobody around or max duration
+    if(carousel.isCycleEnd()) {
       // The cycle should stop
       carousel.endCarousel();
+#ifdef _DEBUG
+      // Show what happened during the cycle
+      carousel.getTimeline().dump(Serial);
+#endif
     } // Time elapsed
   } // Pir is active
   else {
@@ -88,86 +158,152 @@ void loop() {
     if(carousel.isPir()) {
     }
   } // Movement detection
+  PROFILE_END(PHASE_PIR);
 
   // Update the hardware components, accordingly with 
   // the machine status
+  PROFILE_BEGIN(PHASE_HARDWARE);
   carousel.updateHardware();
+  PROFILE_END(PHASE_HARDWARE);
+
+  // Sample the machine status and publish the changes
+  telemetry.update(carousel, millis());
+  if( (connection.isConnected()) && (telemetry.isPublishDue(millis())) ) {
+    publishTelemetry();
+  }
+
+#ifdef _PROFILE
+  // Report the loop timing
+  if( (connection.isConnected()) && ((millis() - timerProfile) >= PROFILE_DUMP_INTERVAL) ) {
+    timerProfile = millis();
+    publishProfile();
+  }
+#endif
+
+  // Loop duration, without the idle sleep counted in the power stats
+  PROFILE_LOOP_END();
+  telemetry.addLoop(micros() - loopStart);
+
+  // Sleep while nothing is running. The sleep is short enough
+  // to keep the broker connection alive
+  carousel.idle();
 } // Main loop
 
 // ======================================== IoT functions
 
-//! Try to connect to the WiFi and retry after a delay if connection is not possible
-void connectWiFi() {
+//! Start a connection to the WiFi, without waiting for it: the connection
+//! manager polls the WiFi status until WIFI_CONNECT_TIMEOUT and retries
+//! if it fails
+boolean connectWiFi() {
+  uint8_t status;
+
 #ifdef _DEBUG
-  Serial << "Attempting to connect to SSID: " << ssid << " ";
+  Serial << "Attempting to connect to SSID: " << ssid << endl;
 #endif
 
-  //! Set the internal fixed IP address of the MKR100 board
-  IPAddress ip(192, 168, 0, 250);
+  status = WiFi.begin(ssid, pass);
+  return (status != WL_NO_SHIELD) && (status != WL_CONNECT_FAILED);
+}
 
-  // Configure the WiFi to a fixed IP address
-  WiFi.config(ip);
+//! Check the WiFi connection
+boolean isWiFiConnected() {
+  return WiFi.status() == WL_CONNECTED;
+}
 
-  while (WiFi.begin(ssid, pass) != WL_CONNECTED) {
-#ifdef _DEBUG
-    Serial << ".";
-#endif
-    delay(CONN_DELAY);
-  }
+//! Single attempt to connect the client to the server broker. The
+//! connection manager retries if it fails
+boolean connectMQTT() {
 #ifdef _DEBUG
-  Serial << endl << "You're connected to the network" << endl;
+  Serial << "Attempting to MQTT broker: " << mqttServer << endl;
 #endif
+
+  return mqttClient.connect(MQTT_CLIENT_ID);
+}
+
+//! Check the MQTT broker connection
+boolean isMQTTConnected() {
+  return mqttClient.connected();
 }
 
-void connectMQTT() {
+//! Subscribe the topics when the connection is established
+boolean subscribeMQTT() {
 #ifdef _DEBUG
-  Serial << "Attempting to MQTT broker: " << mqttServer << " ";
+  Serial << "MQTT broker connection established" << endl;
 #endif
 
-  //! Start the client on the local LAN
-  mqttClient.begin(mqttServer, MQTT_BROKER_PORT, wifiClient);
+  // subscribe to a topic
+  return mqttClient.subscribe(MQTT_CLIENT_SUBSCRIBER);
+}
+
+//! Message reeived callback function
+void onMessageReceived(MQTTClient *client, char topic[], char bytes[], int length) {
+  MqttCommand cmd;
 
-  //! Connect the client to the server broker
-  while (!mqttClient.connect(mqttServer, MQTT_BROKER_PORT)) {
-    // failed, retry
 #ifdef _DEBUG
-    Serial << ".";
+  Serial << "Received the message " << topic <<
+  ", length " << length << endl;
 #endif
-    delay(CONN_DELAY);
+
+  // Validate the topic and the command
+  if(strcmp(topic, MQTT_CLIENT_SUBSCRIBER) != 0) {
+    return;
   }
+  if( (length > 0) && ((byte)bytes[0] == SHOW_FRAME_MAGIC) ) {
+    // New show, played by the show command
+    carousel.mqttLoadShow((const byte*)bytes, length);
+  } else if(parseCommand(bytes, length, cmd)) {
+    if(cmd.id == MQTTCMD_SWEEP) {
+      // Sweep profiles are applied immediately
+      carousel.setSweepProfile(cmd.level);
+    } else {
+      // Queue the command to be executed
+      carousel.mqttSetCommand(cmd);
+    }
+  } // Command validated
+}
 
-#ifdef _DEBUG
-  Serial << endl << "MQTT broker connection established" << endl;
-#endif
+//! Publish the telemetry samples waiting
+void publishTelemetry() {
+  BufferPrint message(telemetryBuffer, TELEMETRY_BUFFER_SIZE);
+  JsonWriter json(message);
 
-  // Acrtivate the message callback
-  mqttClient.onMessage(onMessageReceived);
+  json.beginObject();
+  json.add("id", MQTT_CLIENT_ID);
+  telemetry.write(json);
+  connection.write(json, "connection", millis());
+  writePowerStats(json);
+  json.endObject();
+  // A truncated message is not valid Json, count it as failed
+  telemetry.published(!message.isOverflow() &&
+                      mqttClient.publish(MQTT_CLIENT_TELEMETRY, message.getBuffer(), message.getLength()),
+                      millis());
+}
 
-  // subscribe to a topic
-  mqttClient.subscribe(MQTT_CLIENT_SUBSCRIBER);
+//! Add the idle and sleep statistics to a Json message
+void writePowerStats(JsonWriter &json) {
+  PowerStats power = carousel.getPowerStats();
+
+  json.beginObject("power");
+  json.add("active", getActiveTime(power, millis()));
+  json.add("sleep", power.sleepTime);
+  json.add("sleeps", power.sleeps);
+  json.add("wakeups", power.wakeups);
+  json.add("wakeLatency", power.maxWakeLatency);
+  json.add("detaches", power.detaches);
+  json.endObject();
 }
 
-//! Message reeived callback function
-void onMessageReceived(String &topic, String &payload) {
+//! Report the loop timing statistics to the serial (debug) and
+//! to the broker, then start a new measure
+void publishProfile() {
+#ifdef _PROFILE
+  BufferPrint message(profileBuffer, PROFILE_BUFFER_SIZE);
+
 #ifdef _DEBUG
-  Serial << "Received the message " << topic <<
-  ": " << payload << endl;
+  profiler.dump(Serial);
+#endif
+  profiler.dump(message);
+  mqttClient.publish(MQTT_CLIENT_PROFILE, message.getBuffer(), message.getLength());
+  profiler.reset();
 #endif
-
-  // Validate the topic
-  if(topic.equals(MQTT_CLIENT_SUBSCRIBER) ) {
-    // Set the correct command ID (if recognized)
-    if(payload.equals(MQTT_LIGTHS) ) {
-      carousel.mqttSetMqtt(true);
-      carousel.mqttSetCommand(MQTTCMD_LIGTHS);
-    } // Cmd lights
-    if(payload.equals(MQTT_MUSIC) ) {
-      carousel.mqttSetMqtt(true);
-      carousel.mqttSetCommand(MQTTCMD_MUSIC);
-    } // Cmd music
-    if(payload.equals(MQTT_RUN) ) {
-      carousel.mqttSetMqtt(true);
-      carousel.mqttSetCommand(MQTTCMD_RUN);
-    } // Cmd run
-  } // Topic validated
 }
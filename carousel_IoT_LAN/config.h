@@ -0,0 +1,36 @@
+/**
+ * \file config.h
+ * \brief Configuration of the carousel_IoT_LAN sketch
+ * 
+ * The carousel core (state machine, outputs, ramps, faders etc.) is the
+ * CarouselCore library in libraries/, shared by all the sketches. This file
+ * selects the features compiled in this sketch.
+ * 
+ * \date May 2019
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * 
+ */
+
+#ifndef _CONFIG
+#define _CONFIG
+
+// Undef to avoid serial output of debug
+#define _DEBUG
+
+// Define to add the loop timing instrumentation and its reports (enabled
+// in the host build)
+// #define _PROFILE
+
+// ========================================== MQTT topics and buffers
+
+//! The subscriber topic for the carousel thing topic
+#define MQTT_CLIENT_SUBSCRIBER "/start"
+#define MQTT_CLIENT_TELEMETRY "/telemetry" ///< Telemetry topic
+#define MQTT_CLIENT_PROFILE "/profile"     ///< Instrumentation reports topic
+#define MQTT_CLIENT_ID "carouselLAN"       ///< Client ID reported in the telemetry messages
+#define TELEMETRY_BUFFER_SIZE 768          ///< Size of the telemetry message buffer
+#define PROFILE_BUFFER_SIZE 640            ///< Size of the instrumentation report buffer
+#define MQTT_BUFFER_SIZE 1024              ///< Size of the MQTT client buffers
+
+#endif
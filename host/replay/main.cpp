@@ -0,0 +1,58 @@
+/**
+ * \file main.cpp
+ * \brief Replay a PIR and remote commands log, printing the carousel timeline
+ *
+ * Usage: carousel_replay [log]\n
+ * The log is read from the standard input if no file is given. The timeline
+ * is printed on the standard output, the statistics on the standard error.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "replay.h"
+#include <chrono>
+
+int main(int argc, char *argv[]) {
+  FILE *log = stdin;
+  FilePrint out(stdout);
+  Replay replay;
+  ReplayEvent e;
+  ReplayStats stats;
+  char line[256];
+  unsigned long lineNum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double wallMs;
+
+  if(argc > 1) {
+    log = fopen(argv[1], "r");
+    if(log == NULL) {
+      fprintf(stderr, "Can't open %s\n", argv[1]);
+      return 1;
+    }
+  }
+
+  replay.begin(&out);
+  while(fgets(line, sizeof(line), log) != NULL) {
+    lineNum++;
+    if(!Replay::parse(line, e)) {
+      fprintf(stderr, "Line %lu: invalid event\n", lineNum);
+      return 1;
+    }
+    if( (e.kind != REPLAY_NONE) && (e.time < millis()) ) {
+      fprintf(stderr, "Line %lu: event out of order\n", lineNum);
+      return 1;
+    }
+    replay.feed(e);
+  }
+  replay.finish();
+
+  stats = replay.getStats();
+  wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  fprintf(stderr, "%lu events, %lu cycles, %lu commands, %lu transitions (%lu lost)\n",
+          stats.events, stats.cycles, stats.commands, stats.transitions, stats.lost);
+  fprintf(stderr, "%.2f virtual hours in %.0f ms, %lu steps\n",
+          millis() / 3600000.0, wallMs, stats.steps);
+  return 0;
+}
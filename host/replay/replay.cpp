@@ -0,0 +1,151 @@
+/**
+ * \file replay.cpp
+ * \brief Virtual time replay of the PIR and remote commands logs
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "replay.h"
+#include <ctype.h>
+
+Replay::Replay() {
+  out = NULL;
+  memset(&stats, 0, sizeof(stats));
+}
+
+boolean Replay::parse(const char *line, ReplayEvent &e) {
+  char kind[8];
+  char payload[CMD_MESSAGE_SIZE];
+  int len;
+
+  e.kind = REPLAY_NONE;
+  while(isspace((unsigned char)*line)) {
+    line++;
+  }
+  if( (*line == 0) || (*line == '#') ) {
+    return true;
+  }
+  if(sscanf(line, "%lu %7s %63s", &e.time, kind, payload) != 3) {
+    return false;
+  }
+  if(strcmp(kind, "pir") == 0) {
+    e.kind = REPLAY_PIR;
+    e.level = atoi(payload) != 0 ? HIGH : LOW;
+    return true;
+  }
+  if(strcmp(kind, "mqtt") == 0) {
+    len = strlen(payload);
+    if(parseCommand(payload, len, e.cmd)) {
+      e.kind = REPLAY_MQTT;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Replay::begin(Print *o) {
+  out = o;
+  memset(&stats, 0, sizeof(stats));
+  sim::reset();
+  sim::recordWrites(false);
+  sim::setPin(PIR_PIN, LOW);
+  machine.initHardware();
+  machine.initStatus();
+  flush();
+}
+
+void Replay::flush() {
+  Timeline &timeline = machine.getTimeline();
+  Transition tr;
+  int j;
+
+  stats.lost += timeline.getLost();
+  for(j = 0; j < timeline.size(); j++) {
+    tr = timeline.get(j);
+    if( (tr.kind == TRANSITION_PIR) && (tr.value == 1) ) {
+      stats.cycles++;
+    }
+    if( (tr.kind == TRANSITION_MQTT) && (tr.value != 0) ) {
+      stats.commands++;
+    }
+  }
+  stats.transitions += timeline.size();
+  if(out != NULL) {
+    timeline.dump(*out);
+  } else {
+    timeline.clear();
+  }
+}
+
+void Replay::step() {
+  machine.mqttCheckStatus();
+  if(machine.isPir()) {
+    if(machine.isCycleEnd()) {
+      machine.endCarousel();
+    }
+  } else {
+    machine.checkPirStatus();
+  }
+  machine.updateHardware();
+  flush();
+  stats.steps++;
+}
+
+void Replay::runTo(unsigned long t) {
+  unsigned long next;
+  unsigned long wait;
+
+  while(true) {
+    step();
+    if(millis() >= t) {
+      return;
+    }
+    // Nothing changes before the next internal event
+    next = machine.getNextEventDelay();
+    wait = t - millis();
+    if(next < wait) {
+      wait = max(next, 1UL);
+    }
+    sim::advance(wait);
+  }
+}
+
+void Replay::feed(const ReplayEvent &e) {
+  MqttCommand cmd;
+
+  if(e.kind == REPLAY_NONE) {
+    return;
+  }
+  runTo(e.time);
+  stats.events++;
+  if(e.kind == REPLAY_PIR) {
+    // The interrupt queues the edge, as on the board
+    sim::setPin(PIR_PIN, e.level);
+  } else {
+    cmd = e.cmd;
+    if(cmd.id == MQTTCMD_SWEEP) {
+      machine.setSweepProfile(cmd.level);
+    } else {
+      machine.mqttSetCommand(cmd);
+    }
+  }
+}
+
+void Replay::finish(unsigned long maxMs) {
+  unsigned long end = millis() + maxMs;
+
+  do {
+    runTo(min(end, millis() + 1000UL));
+  } while( (millis() < end) &&
+           !(machine.isIdle() && (machine.getNextEventDelay() == NO_EVENT)) );
+}
+
+ReplayStats Replay::getStats() {
+  return stats;
+}
+
+StateMachine& Replay::getMachine() {
+  return machine;
+}
@@ -0,0 +1,135 @@
+/**
+ * \file replay.h
+ * \brief Virtual time replay of the PIR and remote commands logs
+ *
+ * The log events are fed to a StateMachine running on the simulated core, as
+ * the carousel_IoT_LAN loop does: mqttCheckStatus(), checkPirStatus() or the
+ * cycle end check, updateHardware(). Between two events the virtual clock
+ * jumps forward by getNextEventDelay(), so the idle gaps cost nothing and
+ * a month of events is replayed in seconds.
+ *
+ * The log is a text file, one event per line, with the times (ms from the
+ * start) in order:
+ *
+ *     # comment
+ *     <ms> pir <0|1>       PIR sensor output level
+ *     <ms> mqtt <command>  Remote command payload (text, e.g. mqtt_run)
+ *
+ * The transitions of the state machine timeline are printed one per line,
+ * as Timeline::dump() does: <ms> <kind> <value>.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _REPLAY
+#define _REPLAY
+
+#include "sim.h"
+#include "statemachine.h"
+#include "protocol.h"
+#include <stdio.h>
+
+#define REPLAY_NONE 0       ///< Empty or comment line
+#define REPLAY_PIR 1        ///< PIR level change event
+#define REPLAY_MQTT 2       ///< Remote command event
+#define REPLAY_DRAIN (PRESENCE_MAX_CYCLE + PRESENCE_COOLDOWN) ///< Max time (ms) run after the last event
+
+//! Event of a replay log
+typedef struct {
+  unsigned long time;       ///< Event time (ms)
+  int kind;                 ///< Event kind (REPLAY_xxx)
+  int level;                ///< PIR level
+  MqttCommand cmd;          ///< Remote command
+} ReplayEvent;
+
+//! Replay statistics
+typedef struct {
+  unsigned long events;     ///< Events replayed
+  unsigned long steps;      ///< Loop cycles executed
+  unsigned long transitions; ///< Transitions printed
+  unsigned long cycles;     ///< Carousel cycles started by the PIR
+  unsigned long commands;   ///< Remote commands executed
+  unsigned long lost;       ///< Transitions lost by the timeline
+} ReplayStats;
+
+//! Print to a C file, e.g. stdout
+class FilePrint : public Print {
+  private:
+  FILE *file;
+
+  public:
+  FilePrint(FILE *f) : file(f) {}
+  size_t write(uint8_t b) override { return fputc(b, file) == EOF ? 0 : 1; }
+  using Print::write;
+};
+
+//! Replay engine
+class Replay {
+  private:
+  //! The carousel
+  StateMachine machine;
+  //! Timeline output, NULL to count the transitions only
+  Print *out;
+  //! Statistics
+  ReplayStats stats;
+
+  /**
+   * Run a loop cycle and print the new transitions
+   */
+  void step();
+
+  /**
+   * Print the transitions recorded and empty the timeline
+   */
+  void flush();
+
+  public:
+  Replay();
+
+  /**
+   * Parse a log line
+   * @param line The line
+   * @param e Filled with the event
+   * @return false if the line is not valid. Empty and comment lines
+   * are valid, with kind REPLAY_NONE
+   */
+  static boolean parse(const char *line, ReplayEvent &e);
+
+  /**
+   * Restart the simulation and initialize the carousel at the time 0
+   * @param o Timeline output, NULL to count the transitions only
+   */
+  void begin(Print *o);
+
+  /**
+   * Run the carousel until a time
+   * @param t The time (ms)
+   */
+  void runTo(unsigned long t);
+
+  /**
+   * Run the carousel until the event time and apply it
+   * @param e The event
+   */
+  void feed(const ReplayEvent &e);
+
+  /**
+   * Run the carousel after the last event, until nothing is running
+   * @param maxMs Max time (ms) to run
+   */
+  void finish(unsigned long maxMs = REPLAY_DRAIN);
+
+  /**
+   * Get the replay statistics
+   */
+  ReplayStats getStats();
+
+  /**
+   * Get the carousel state machine
+   */
+  StateMachine& getMachine();
+};
+
+#endif
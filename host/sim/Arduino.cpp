@@ -0,0 +1,798 @@
+/**
+ * \file Arduino.cpp
+ * \brief Simulated Arduino core: virtual clock, pins, interrupts, serials
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "EEPROM.h"
+#include <chrono>
+#include <map>
+#include <stdio.h>
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+EEPROMClass EEPROM;
+
+namespace {
+
+//! Virtual time (us)
+unsigned long long clockMicros = 0;
+//! Scheduled events, by time. Events with the same time run in order
+std::multimap<unsigned long long, std::function<void()> > events;
+
+int pinLevel[NUM_SIM_PINS];
+int pinAnalogIn[NUM_SIM_PINS];
+int pinAnalogOut[NUM_SIM_PINS];
+uint8_t pinModes[NUM_SIM_PINS];
+//! True if the simulator drives the pin, the pull up is ignored
+boolean pinDriven[NUM_SIM_PINS];
+void (*isr[NUM_SIM_PINS])(void);
+int isrMode[NUM_SIM_PINS];
+
+//! False between noInterrupts() and interrupts()
+boolean interruptsEnabled = true;
+//! Interrupts raised while disabled
+std::vector<void (*)(void)> pendingIsr;
+
+std::vector<sim::PinWrite> writes;
+boolean recording = true;
+sim::ServoState servos[NUM_SIM_PINS];
+
+unsigned long loopCost = SIM_LOOP_COST;
+sim::LoopStats loopStats;
+//! Virtual time (us) the last loop() run started
+unsigned long long lastLoopStart = 0;
+
+uint32_t randomState = 1;
+
+sim::HeapStats heapStats;
+
+boolean validPin(int pin) {
+  return (pin >= 0) && (pin < NUM_SIM_PINS);
+}
+
+//! Call an interrupt routine, or keep it until the interrupts are enabled
+void raise(void (*callback)(void)) {
+  if(interruptsEnabled) {
+    callback();
+  } else {
+    pendingIsr.push_back(callback);
+  }
+}
+
+} // namespace
+
+// ========================================== Time
+
+unsigned long millis() {
+  return (unsigned long)(clockMicros / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)clockMicros;
+}
+
+void delay(unsigned long ms) {
+  sim::advanceMicros(ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+  sim::advanceMicros(us);
+}
+
+void yield() {
+  // Wait for the next SysTick, as a sleeping core would do
+  sim::advanceTo(clockMicros / 1000 + 1);
+}
+
+// ========================================== Pins and interrupts
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if(!validPin(pin)) {
+    return;
+  }
+  pinModes[pin] = mode;
+  if( (mode == INPUT_PULLUP) && !pinDriven[pin] ) {
+    pinLevel[pin] = HIGH;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if(!validPin(pin)) {
+    return;
+  }
+  pinLevel[pin] = (value != LOW) ? HIGH : LOW;
+  sim::recordWrite(SIM_WRITE_DIGITAL, pin, pinLevel[pin]);
+}
+
+int digitalRead(uint8_t pin) {
+  if(!validPin(pin)) {
+    return LOW;
+  }
+  return pinLevel[pin];
+}
+
+void analogWrite(uint8_t pin, int value) {
+  if(!validPin(pin)) {
+    return;
+  }
+  pinAnalogOut[pin] = value;
+  sim::recordWrite(SIM_WRITE_ANALOG, pin, value);
+}
+
+int analogRead(uint8_t pin) {
+  if(!validPin(pin)) {
+    return 0;
+  }
+  return pinAnalogIn[pin];
+}
+
+void attachInterrupt(uint8_t interrupt, void (*callback)(void), int mode) {
+  if(!validPin(interrupt)) {
+    return;
+  }
+  isr[interrupt] = callback;
+  isrMode[interrupt] = mode;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+  if(!validPin(interrupt)) {
+    return;
+  }
+  isr[interrupt] = NULL;
+}
+
+void noInterrupts() {
+  interruptsEnabled = false;
+}
+
+void interrupts() {
+  std::vector<void (*)(void)> pending;
+
+  interruptsEnabled = true;
+  pending.swap(pendingIsr);
+  for(size_t j = 0; j < pending.size(); j++) {
+    pending[j]();
+  }
+}
+
+// ========================================== Math
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+void randomSeed(unsigned long seed) {
+  if(seed != 0) {
+    randomState = (uint32_t)seed;
+  }
+}
+
+long random(long howBig) {
+  if(howBig <= 0) {
+    return 0;
+  }
+  // xorshift32, deterministic for a given seed
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState % howBig;
+}
+
+long random(long howSmall, long howBig) {
+  if(howSmall >= howBig) {
+    return howSmall;
+  }
+  return random(howBig - howSmall) + howSmall;
+}
+
+// ========================================== Simulator
+
+namespace sim {
+
+void reset() {
+  clockMicros = 0;
+  events.clear();
+  for(int j = 0; j < NUM_SIM_PINS; j++) {
+    pinLevel[j] = LOW;
+    pinAnalogIn[j] = 0;
+    pinAnalogOut[j] = -1;
+    pinModes[j] = INPUT;
+    pinDriven[j] = false;
+    isr[j] = NULL;
+    isrMode[j] = CHANGE;
+    servos[j].attached = false;
+    servos[j].value = -1;
+    servos[j].writes = 0;
+    servos[j].attaches = 0;
+  }
+  interruptsEnabled = true;
+  pendingIsr.clear();
+  writes.clear();
+  recording = true;
+  loopCost = SIM_LOOP_COST;
+  memset(&loopStats, 0, sizeof(loopStats));
+  memset(&heapStats, 0, sizeof(heapStats));
+  randomState = 1;
+  Serial.clear();
+  Serial1.clear();
+  resetNetwork();
+}
+
+unsigned long long now() {
+  return clockMicros;
+}
+
+void advanceMicros(unsigned long long us) {
+  unsigned long long target = clockMicros + us;
+  std::function<void()> event;
+
+  // The events can schedule other events, always take the first one
+  while( (!events.empty()) && (events.begin()->first <= target) ) {
+    if(events.begin()->first > clockMicros) {
+      clockMicros = events.begin()->first;
+    }
+    event = events.begin()->second;
+    events.erase(events.begin());
+    event();
+  }
+  clockMicros = target;
+}
+
+void advance(unsigned long ms) {
+  advanceMicros(ms * 1000ULL);
+}
+
+void advanceTo(unsigned long long ms) {
+  if(ms * 1000ULL > clockMicros) {
+    advanceMicros(ms * 1000ULL - clockMicros);
+  }
+}
+
+void at(unsigned long long ms, std::function<void()> event) {
+  events.insert(std::make_pair(ms * 1000ULL, event));
+}
+
+boolean nextEvent(unsigned long long &ms) {
+  if(events.empty()) {
+    return false;
+  }
+  ms = (events.begin()->first + 999) / 1000;
+  return true;
+}
+
+void setPin(int pin, int level) {
+  int old;
+
+  if(!validPin(pin)) {
+    return;
+  }
+  old = pinLevel[pin];
+  pinLevel[pin] = (level != LOW) ? HIGH : LOW;
+  pinDriven[pin] = true;
+  if( (isr[pin] == NULL) || (old == pinLevel[pin]) ) {
+    return;
+  }
+  if( (isrMode[pin] == CHANGE) ||
+      ((isrMode[pin] == RISING) && (pinLevel[pin] == HIGH)) ||
+      ((isrMode[pin] == FALLING) && (pinLevel[pin] == LOW)) ) {
+    raise(isr[pin]);
+  }
+}
+
+void setPinAt(unsigned long long ms, int pin, int level) {
+  at(ms, [pin, level]() { setPin(pin, level); });
+}
+
+void setAnalog(int pin, int value) {
+  if(validPin(pin)) {
+    pinAnalogIn[pin] = value;
+  }
+}
+
+int getPin(int pin) {
+  return validPin(pin) ? pinLevel[pin] : LOW;
+}
+
+int getAnalog(int pin) {
+  return validPin(pin) ? pinAnalogOut[pin] : -1;
+}
+
+const std::vector<PinWrite>& getWrites() {
+  return writes;
+}
+
+void clearWrites() {
+  writes.clear();
+}
+
+void recordWrites(boolean enable) {
+  recording = enable;
+}
+
+void recordWrite(char kind, int pin, int value) {
+  PinWrite w;
+
+  if(!recording) {
+    return;
+  }
+  w.time = millis();
+  w.kind = kind;
+  w.pin = pin;
+  w.value = value;
+  writes.push_back(w);
+}
+
+ServoState getServo(int pin) {
+  return servo(pin);
+}
+
+ServoState& servo(int pin) {
+  static ServoState invalid;
+
+  if(!validPin(pin)) {
+    return invalid;
+  }
+  return servos[pin];
+}
+
+void setLoopCost(unsigned long us) {
+  loopCost = us;
+}
+
+void run(unsigned long ms) {
+  unsigned long long end = clockMicros + ms * 1000ULL;
+  std::chrono::steady_clock::time_point start;
+  double ns;
+
+  while(clockMicros < end) {
+    if( (loopStats.loops > 0) && ((clockMicros - lastLoopStart) > loopStats.maxGapUs) ) {
+      loopStats.maxGapUs = clockMicros - lastLoopStart;
+    }
+    lastLoopStart = clockMicros;
+    start = std::chrono::steady_clock::now();
+    loop();
+    ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    loopStats.loops++;
+    loopStats.wallNs += ns;
+    if(ns > loopStats.maxWallNs) {
+      loopStats.maxWallNs = ns;
+    }
+    advanceMicros(loopCost);
+  }
+}
+
+LoopStats getLoopStats() {
+  return loopStats;
+}
+
+void clearLoopStats() {
+  memset(&loopStats, 0, sizeof(loopStats));
+}
+
+void heapAllocated(unsigned long bytes) {
+  heapStats.allocations++;
+  heapStats.bytes += bytes;
+}
+
+HeapStats getHeapStats() {
+  return heapStats;
+}
+
+} // namespace sim
+
+// ========================================== String
+
+String::String(const char *c) : buffer(NULL), capacity(0), len(0) {
+  if(c != NULL) {
+    copy(c, strlen(c));
+  }
+}
+
+String::String(const std::string &c) : buffer(NULL), capacity(0), len(0) {
+  copy(c.c_str(), c.size());
+}
+
+String::String(const String &other) : buffer(NULL), capacity(0), len(0) {
+  copy(other.c_str(), other.len);
+}
+
+String::String(String &&other) : buffer(other.buffer), capacity(other.capacity), len(other.len) {
+  other.buffer = NULL;
+  other.capacity = 0;
+  other.len = 0;
+}
+
+String::String(char c) : buffer(NULL), capacity(0), len(0) {
+  copy(&c, 1);
+}
+
+String::String(int value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char text[34];
+
+  snprintf(text, sizeof(text), (base == HEX) ? "%x" : "%d", value);
+  copy(text, strlen(text));
+}
+
+String::String(unsigned int value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char text[34];
+
+  snprintf(text, sizeof(text), (base == HEX) ? "%x" : "%u", value);
+  copy(text, strlen(text));
+}
+
+String::String(long value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char text[34];
+
+  snprintf(text, sizeof(text), (base == HEX) ? "%lx" : "%ld", value);
+  copy(text, strlen(text));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char text[34];
+
+  snprintf(text, sizeof(text), (base == HEX) ? "%lx" : "%lu", value);
+  copy(text, strlen(text));
+}
+
+String::String(float value, unsigned char decimals) : buffer(NULL), capacity(0), len(0) {
+  char text[64];
+
+  snprintf(text, sizeof(text), "%.*f", decimals, (double)value);
+  copy(text, strlen(text));
+}
+
+String::String(double value, unsigned char decimals) : buffer(NULL), capacity(0), len(0) {
+  char text[64];
+
+  snprintf(text, sizeof(text), "%.*f", decimals, value);
+  copy(text, strlen(text));
+}
+
+String::~String() {
+  free(buffer);
+}
+
+boolean String::reserve(unsigned int size) {
+  char *grown;
+
+  if( (buffer != NULL) && (capacity >= size) ) {
+    return true;
+  }
+  grown = (char*)realloc(buffer, size + 1);
+  if(grown == NULL) {
+    return false;
+  }
+  sim::heapAllocated(size + 1);
+  buffer = grown;
+  capacity = size;
+  return true;
+}
+
+String& String::copy(const char *c, unsigned int length) {
+  if(!reserve(length)) {
+    return *this;
+  }
+  len = length;
+  memmove(buffer, c, length);
+  buffer[len] = 0;
+  return *this;
+}
+
+boolean String::concat(const char *c, unsigned int length) {
+  if(!reserve(len + length)) {
+    return false;
+  }
+  memmove(buffer + len, c, length);
+  len += length;
+  buffer[len] = 0;
+  return true;
+}
+
+String& String::operator=(const String &other) {
+  if(this != &other) {
+    copy(other.c_str(), other.len);
+  }
+  return *this;
+}
+
+String& String::operator=(String &&other) {
+  if(this != &other) {
+    free(buffer);
+    buffer = other.buffer;
+    capacity = other.capacity;
+    len = other.len;
+    other.buffer = NULL;
+    other.capacity = 0;
+    other.len = 0;
+  }
+  return *this;
+}
+
+String& String::operator=(const char *c) {
+  return copy(c, strlen(c));
+}
+
+const char* String::c_str() const {
+  return (buffer != NULL) ? buffer : "";
+}
+
+unsigned int String::length() const {
+  return len;
+}
+
+boolean String::equals(const String &other) const {
+  return (len == other.len) && (strcmp(c_str(), other.c_str()) == 0);
+}
+
+boolean String::equals(const char *other) const {
+  return strcmp(c_str(), (other != NULL) ? other : "") == 0;
+}
+
+char String::charAt(unsigned int j) const {
+  return (j < len) ? buffer[j] : 0;
+}
+
+String& String::operator+=(const String &other) {
+  concat(other.c_str(), other.len);
+  return *this;
+}
+
+boolean String::operator==(const String &other) const {
+  return equals(other);
+}
+
+boolean String::operator==(const char *other) const {
+  return equals(other);
+}
+
+String operator+(const String &a, const String &b) {
+  String sum(a);
+
+  sum += b;
+  return sum;
+}
+
+// ========================================== Print
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+
+  while(size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::write(const char *str) {
+  if(str == NULL) {
+    return 0;
+  }
+  return write((const uint8_t*)str, strlen(str));
+}
+
+size_t Print::write(const char *buffer, size_t size) {
+  return write((const uint8_t*)buffer, size);
+}
+
+int Print::availableForWrite() {
+  return 0;
+}
+
+void Print::flush() {
+}
+
+size_t Print::printNumber(unsigned long n, int base) {
+  char buffer[8 * sizeof(long) + 1];
+  char *p = &buffer[sizeof(buffer) - 1];
+
+  if(base < 2) {
+    base = 10;
+  }
+  *p = 0;
+  do {
+    int digit = n % base;
+    n /= base;
+    *--p = (digit < 10) ? ('0' + digit) : ('A' + digit - 10);
+  } while(n > 0);
+  return write(p);
+}
+
+size_t Print::printSigned(long n, int base) {
+  if( (base == 10) && (n < 0) ) {
+    return print('-') + printNumber(-(unsigned long)n, 10);
+  }
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(const char *str) {
+  return write(str);
+}
+
+size_t Print::print(const String &str) {
+  return write(str.c_str());
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return printNumber(n, base);
+}
+
+size_t Print::print(int n, int base) {
+  return printSigned(n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return printNumber(n, base);
+}
+
+size_t Print::print(long n, int base) {
+  return printSigned(n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buffer[64];
+
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+  return write(buffer);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::println(const char *str) {
+  return print(str) + println();
+}
+
+size_t Print::println(const String &str) {
+  return print(str) + println();
+}
+
+size_t Print::println(char c) {
+  return print(c) + println();
+}
+
+size_t Print::println(unsigned char n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(double n, int digits) {
+  return print(n, digits) + println();
+}
+
+// ========================================== Stream
+
+Stream::Stream() : timeout(1000) {}
+
+void Stream::setTimeout(unsigned long ms) {
+  timeout = ms;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  return readBytes((uint8_t*)buffer, length);
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+  size_t n = 0;
+  unsigned long start = millis();
+
+  while(n < length) {
+    if(available() > 0) {
+      buffer[n++] = (uint8_t)read();
+    } else if((millis() - start) >= timeout) {
+      break;
+    } else {
+      yield();
+    }
+  }
+  return n;
+}
+
+// ========================================== Serials
+
+//! Max bytes kept in the output buffer, the oldest are dropped
+#define SIM_SERIAL_OUTPUT_MAX (1UL << 20)
+
+SimSerial::SimSerial() : device(NULL), speed(0) {}
+
+void SimSerial::begin(unsigned long baud) {
+  speed = baud;
+}
+
+void SimSerial::end() {
+  speed = 0;
+}
+
+SimSerial::operator bool() {
+  return true;
+}
+
+size_t SimSerial::write(uint8_t b) {
+  if(device != NULL) {
+    device->receive(b);
+  } else {
+    if(tx.size() >= SIM_SERIAL_OUTPUT_MAX) {
+      tx.erase(0, SIM_SERIAL_OUTPUT_MAX / 2);
+    }
+    tx.push_back((char)b);
+  }
+  return 1;
+}
+
+int SimSerial::availableForWrite() {
+  return 64;
+}
+
+int SimSerial::available() {
+  return rx.size();
+}
+
+int SimSerial::read() {
+  int b;
+
+  if(rx.empty()) {
+    return -1;
+  }
+  b = rx.front();
+  rx.pop_front();
+  return b;
+}
+
+int SimSerial::peek() {
+  return rx.empty() ? -1 : rx.front();
+}
+
+unsigned long SimSerial::getSpeed() {
+  return speed;
+}
+
+void SimSerial::connect(SimDevice *d) {
+  device = d;
+}
+
+void SimSerial::inject(const uint8_t *buffer, size_t size) {
+  rx.insert(rx.end(), buffer, buffer + size);
+}
+
+void SimSerial::inject(const char *str) {
+  inject((const uint8_t*)str, strlen(str));
+}
+
+std::string& SimSerial::output() {
+  return tx;
+}
+
+void SimSerial::clear() {
+  rx.clear();
+  tx.clear();
+  device = NULL;
+  speed = 0;
+}
@@ -0,0 +1,283 @@
+/**
+ * \file Arduino.h
+ * \brief Simulated Arduino core for the host build
+ *
+ * The sketches are compiled on the host against this core instead of the
+ * board core. Time is virtual: millis() and micros() only move when the
+ * simulator advances the clock (see sim.h), delay() and yield() move it
+ * forward. The pin writes are recorded, the pin reads and the interrupts
+ * are driven by the simulator, the serials are memory buffers.
+ *
+ * Only the part of the Arduino API used by the carousel sketches is
+ * available.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _ARDUINO_SIM
+#define _ARDUINO_SIM
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <type_traits>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 2
+#define FALLING 3
+#define RISING 4
+
+#define DEC 10
+#define HEX 16
+
+#define A0 15
+#define A1 16
+#define A2 17
+#define A3 18
+#define A4 19
+#define A5 20
+#define A6 21
+
+#define NUM_SIM_PINS 32     ///< Number of simulated pins
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+
+#define digitalPinToInterrupt(p) (p)
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+// min(), max() and constrain() are templates so the standard headers
+// can be included after this one
+template<class T, class U>
+inline typename std::common_type<T, U>::type min(T a, U b) {
+  return (a < b) ? a : b;
+}
+
+template<class T, class U>
+inline typename std::common_type<T, U>::type max(T a, U b) {
+  return (a > b) ? a : b;
+}
+
+template<class T, class L, class H>
+inline T constrain(T x, L low, H high) {
+  return (x < low) ? low : ((x > high) ? high : x);
+}
+
+inline uint16_t word(uint8_t h, uint8_t l) {
+  return (h << 8) | l;
+}
+
+// ========================================== Time
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// ========================================== Pins and interrupts
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*callback)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+
+// ========================================== Math
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+void randomSeed(unsigned long seed);
+long random(long howBig);
+long random(long howSmall, long howBig);
+
+// ========================================== Strings and streams
+
+//! Dynamic string, as the Arduino String class. The text is kept in a
+//! buffer allocated on the heap, grown with realloc() as needed
+class String {
+  private:
+  char *buffer;
+  unsigned int capacity;
+  unsigned int len;
+
+  //! Make room for a text length
+  boolean reserve(unsigned int size);
+  //! Replace the text
+  String& copy(const char *c, unsigned int length);
+  //! Append a text
+  boolean concat(const char *c, unsigned int length);
+
+  public:
+  String(const char *c = "");
+  String(const std::string &c);
+  String(const String &other);
+  String(String &&other);
+  String(char c);
+  String(int value, unsigned char base = DEC);
+  String(unsigned int value, unsigned char base = DEC);
+  String(long value, unsigned char base = DEC);
+  String(unsigned long value, unsigned char base = DEC);
+  String(float value, unsigned char decimals = 2);
+  String(double value, unsigned char decimals = 2);
+  ~String();
+
+  String& operator=(const String &other);
+  String& operator=(String &&other);
+  String& operator=(const char *c);
+  const char* c_str() const;
+  unsigned int length() const;
+  boolean equals(const String &other) const;
+  boolean equals(const char *other) const;
+  char charAt(unsigned int j) const;
+  String& operator+=(const String &other);
+  boolean operator==(const String &other) const;
+  boolean operator==(const char *other) const;
+  friend String operator+(const String &a, const String &b);
+};
+
+//! Character output, as the Arduino Print class
+class Print {
+  private:
+  size_t printNumber(unsigned long n, int base);
+  size_t printSigned(long n, int base);
+
+  public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str);
+  size_t write(const char *buffer, size_t size);
+  virtual int availableForWrite();
+  virtual void flush();
+
+  size_t print(const char *str);
+  size_t print(const String &str);
+  size_t print(char c);
+  size_t print(unsigned char n, int base = DEC);
+  size_t print(int n, int base = DEC);
+  size_t print(unsigned int n, int base = DEC);
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+
+  size_t println();
+  size_t println(const char *str);
+  size_t println(const String &str);
+  size_t println(char c);
+  size_t println(unsigned char n, int base = DEC);
+  size_t println(int n, int base = DEC);
+  size_t println(unsigned int n, int base = DEC);
+  size_t println(long n, int base = DEC);
+  size_t println(unsigned long n, int base = DEC);
+  size_t println(double n, int digits = 2);
+};
+
+//! Character input and output, as the Arduino Stream class
+class Stream : public Print {
+  protected:
+  //! Max time (ms) readBytes() waits for the data
+  unsigned long timeout;
+
+  public:
+  Stream();
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long ms);
+  size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length);
+};
+
+//! Device connected to a simulated serial, e.g. the fake DFPlayer
+class SimDevice {
+  public:
+  virtual ~SimDevice() {}
+  //! A byte has been sent to the device
+  virtual void receive(uint8_t b) = 0;
+};
+
+/**
+ * Simulated serial port. The bytes written by the sketch go to the connected
+ * device, or are kept in the output buffer read by the tests. The bytes
+ * injected by the device or by the tests are read by the sketch.
+ */
+class SimSerial : public Stream {
+  private:
+  //! Bytes waiting to be read by the sketch
+  std::deque<uint8_t> rx;
+  //! Bytes written by the sketch, when no device is connected
+  std::string tx;
+  //! Device receiving the bytes written by the sketch
+  SimDevice *device;
+  //! Speed set by the sketch, 0 if not started
+  unsigned long speed;
+
+  public:
+  SimSerial();
+
+  //! Start the serial
+  void begin(unsigned long baud);
+  void end();
+  //! Always ready, as the USB serial of the boards
+  operator bool();
+
+  size_t write(uint8_t b) override;
+  using Print::write;
+  int availableForWrite() override;
+  int available() override;
+  int read() override;
+  int peek() override;
+
+  // ========================================== Simulator side
+
+  //! Get the speed set by the sketch, 0 if the serial has not been started
+  unsigned long getSpeed();
+  //! Connect a device receiving the bytes written by the sketch, NULL to disconnect
+  void connect(SimDevice *d);
+  //! Send bytes to the sketch
+  void inject(const uint8_t *buffer, size_t size);
+  //! Send a string to the sketch
+  void inject(const char *str);
+  //! Get the bytes written by the sketch
+  std::string& output();
+  //! Empty the buffers
+  void clear();
+};
+
+//! The board serials
+class HardwareSerial : public SimSerial {
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+// ========================================== Sketch
+
+void setup();
+void loop();
+
+#endif
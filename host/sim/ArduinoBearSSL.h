@@ -0,0 +1,37 @@
+/**
+ * \file ArduinoBearSSL.h
+ * \brief Fake ArduinoBearSSL library for the host build
+ *
+ * The TLS client is a pass through: the handshake time is simulated by the
+ * MQTT client fake when it connects (see simnet.h).
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _ARDUINOBEARSSL_SIM
+#define _ARDUINOBEARSSL_SIM
+
+#include "Arduino.h"
+#include "WiFi101.h"
+
+//! TLS client over another client
+class BearSSLClient : public Client {
+  private:
+  Client *client;
+
+  public:
+  BearSSLClient(Client &c);
+  void setEccSlot(int slot, const char cert[]);
+};
+
+//! Time source of the certificates validation
+class ArduinoBearSSLClass {
+  public:
+  void onGetTime(unsigned long (*callback)());
+};
+
+extern ArduinoBearSSLClass ArduinoBearSSL;
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * \file ArduinoECCX08.h
+ * \brief Fake crypto chip for the host build, always present
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _ARDUINOECCX08_SIM
+#define _ARDUINOECCX08_SIM
+
+#include "Arduino.h"
+
+//! Crypto chip
+class ECCX08Class {
+  public:
+  int begin();
+};
+
+extern ECCX08Class ECCX08;
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * \file ArduinoMqttClient.h
+ * \brief Fake ArduinoMqttClient library for the host build
+ *
+ * As the real library a message started without its size is buffered in
+ * TX_PAYLOAD_BUFFER_SIZE bytes and the bytes exceeding it are lost, while a
+ * message started with its size is streamed and endMessage() fails if the
+ * bytes written are not the size declared. The published messages are kept
+ * by the simulator (see simnet.h).
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _ARDUINOMQTTCLIENT_SIM
+#define _ARDUINOMQTTCLIENT_SIM
+
+#include "Arduino.h"
+#include "WiFi101.h"
+
+#define TX_PAYLOAD_BUFFER_SIZE 256  ///< Buffer of the messages started without size
+#define MQTT_CLIENT_CONNECT_TIMEOUT 30000UL ///< Default connection timeout (ms) of the library
+
+//! MQTT client
+class MqttClient : public Client {
+  private:
+  //! Message received callback
+  void (*onMessageCallback)(int);
+  //! True while connected to the broker
+  boolean isConnected;
+  //! Max time (ms) a connection attempt waits for the broker
+  unsigned long connectTimeout;
+  //! Message being written
+  std::string txTopic;
+  std::string txPayload;
+  //! Size declared by beginMessage(), 0 if buffered
+  unsigned long txSize;
+  //! True if a message has been started
+  boolean txStarted;
+  //! Message being read
+  std::string rxTopic;
+  std::string rxPayload;
+  size_t rxIndex;
+
+  public:
+  MqttClient(Client &c);
+  MqttClient(Client *c);
+
+  void setId(const char *id);
+  void setKeepAliveInterval(unsigned long ms);
+  void onMessage(void (*callback)(int));
+  void setConnectionTimeout(unsigned long ms);
+  int connect(const char *host, uint16_t port = 1883);
+  uint8_t connected() override;
+  void stop() override;
+  int connectError();
+  void poll();
+  int subscribe(const char *topic, uint8_t qos = 0);
+
+  int beginMessage(const char *topic, unsigned long size, bool retain = false, uint8_t qos = 0, bool dup = false);
+  int beginMessage(const char *topic, bool retain = false, uint8_t qos = 0, bool dup = false);
+  int endMessage();
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  String messageTopic();
+  int messageSize();
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override;
+};
+
+#endif
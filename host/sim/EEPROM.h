@@ -0,0 +1,66 @@
+/**
+ * \file EEPROM.h
+ * \brief Simulated EEPROM for the host build
+ *
+ * The size of the Nano EEPROM, erased (0xFF) when the program starts. It
+ * is not cleared by sim::reset(), as the EEPROM keeps its content when the
+ * board is powered off.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _EEPROM_SIM
+#define _EEPROM_SIM
+
+#include "Arduino.h"
+
+#define EEPROM_SIM_SIZE 1024    ///< EEPROM size (bytes)
+
+//! Simulated EEPROM, the part of the Arduino EEPROM library used by the sketches
+class EEPROMClass {
+  private:
+  uint8_t data[EEPROM_SIM_SIZE];
+  //! Number of the writes, to check the wear
+  unsigned long writes;
+
+  public:
+  EEPROMClass() : writes(0) { memset(data, 0xFF, EEPROM_SIM_SIZE); }
+
+  uint8_t read(int idx) { return data[idx]; }
+
+  void write(int idx, uint8_t val) {
+    data[idx] = val;
+    writes++;
+  }
+
+  void update(int idx, uint8_t val) {
+    if(data[idx] != val) {
+      write(idx, val);
+    }
+  }
+
+  uint16_t length() { return EEPROM_SIM_SIZE; }
+
+  template<typename T> T &get(int idx, T &t) {
+    memcpy(&t, &data[idx], sizeof(T));
+    return t;
+  }
+
+  template<typename T> const T &put(int idx, const T &t) {
+    const uint8_t *p = (const uint8_t*)&t;
+
+    for(size_t j = 0; j < sizeof(T); j++) {
+      update(idx + j, p[j]);
+    }
+    return t;
+  }
+
+  //! Get the number of the bytes written since the program started
+  unsigned long getWrites() { return writes; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
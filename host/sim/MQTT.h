@@ -0,0 +1,54 @@
+/**
+ * \file MQTT.h
+ * \brief Fake 256dpi MQTT library for the host build
+ *
+ * The messages longer than the client buffer can't be published, as with
+ * the real library. The published messages are kept by the simulator
+ * (see simnet.h).
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _MQTT_SIM
+#define _MQTT_SIM
+
+#include "Arduino.h"
+#include "WiFi101.h"
+
+class MQTTClient;
+
+typedef void (*MQTTClientCallbackSimple)(String &topic, String &payload);
+typedef void (*MQTTClientCallbackAdvanced)(MQTTClient *client, char topic[], char bytes[], int length);
+
+//! MQTT client
+class MQTTClient {
+  private:
+  //! Size of the read and write buffers
+  int bufSize;
+  //! Message received callback
+  MQTTClientCallbackAdvanced callback;
+  //! True while connected to the broker
+  boolean isConnected;
+  //! Max time (ms) the commands wait for the broker answer
+  int timeout;
+
+  public:
+  MQTTClient(int bufSize = 128);
+
+  void begin(const char hostname[], int port, Client &client);
+  void begin(const char hostname[], Client &client);
+  void onMessageAdvanced(MQTTClientCallbackAdvanced cb);
+  void setTimeout(int ms);
+  bool connect(const char clientId[], bool skip = false);
+  bool connected();
+  void disconnect();
+  bool loop();
+  bool subscribe(const char topic[], int qos = 0);
+  bool publish(const char topic[], const char payload[], int length);
+  bool publish(const char topic[], const char payload[]);
+  int lastError();
+};
+
+#endif
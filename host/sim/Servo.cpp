@@ -0,0 +1,52 @@
+/**
+ * \file Servo.cpp
+ * \brief Fake servo for the host build
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "Servo.h"
+#include "sim.h"
+
+Servo::Servo() : pin(-1), value(90) {}
+
+uint8_t Servo::attach(int p) {
+  pin = p;
+  sim::servo(pin).attached = true;
+  sim::servo(pin).attaches++;
+  return (uint8_t)p;
+}
+
+uint8_t Servo::attach(int p, int minUs, int maxUs) {
+  return attach(p);
+}
+
+void Servo::detach() {
+  if(pin >= 0) {
+    sim::servo(pin).attached = false;
+  }
+  pin = -1;
+}
+
+void Servo::write(int v) {
+  value = constrain(v, 0, 180);
+  if(pin >= 0) {
+    sim::servo(pin).value = value;
+    sim::servo(pin).writes++;
+    sim::recordWrite(SIM_WRITE_SERVO, pin, value);
+  }
+}
+
+void Servo::writeMicroseconds(int us) {
+  write(map(us, 544, 2400, 0, 180));
+}
+
+int Servo::read() {
+  return value;
+}
+
+bool Servo::attached() {
+  return pin >= 0;
+}
@@ -0,0 +1,40 @@
+/**
+ * \file Servo.h
+ * \brief Fake servo for the host build
+ *
+ * The servos do not move: the attach, detach and write calls are recorded
+ * by pin in the simulator (see sim::getServo()) and the writes are added
+ * to the outputs log.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SERVO_SIM
+#define _SERVO_SIM
+
+#include "Arduino.h"
+
+#define INVALID_SERVO 255   ///< Channel returned by attach() on failure
+
+//! Fake servo, same interface of the Arduino Servo library
+class Servo {
+  private:
+  //! Attached pin, -1 if not attached
+  int pin;
+  //! Last angle (or speed) written
+  int value;
+
+  public:
+  Servo();
+  uint8_t attach(int p);
+  uint8_t attach(int p, int minUs, int maxUs);
+  void detach();
+  void write(int v);
+  void writeMicroseconds(int us);
+  int read();
+  bool attached();
+};
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * \file SoftwareSerial.h
+ * \brief Simulated software serial for the host build
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SOFTWARESERIAL_SIM
+#define _SOFTWARESERIAL_SIM
+
+#include "Arduino.h"
+
+//! Software serial, a memory buffer as the other simulated serials
+class SoftwareSerial : public SimSerial {
+  public:
+  SoftwareSerial(uint8_t rx, uint8_t tx, bool inverse = false) {}
+  bool listen() { return true; }
+  bool isListening() { return true; }
+};
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * \file Streaming.h
+ * \brief C++ stream style output, as the Streaming library
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _STREAMING_SIM
+#define _STREAMING_SIM
+
+#include "Arduino.h"
+
+template<class T>
+inline Print& operator<<(Print &obj, T arg) {
+  obj.print(arg);
+  return obj;
+}
+
+//! End of line marker
+enum _EndLineCode { endl };
+
+inline Print& operator<<(Print &obj, _EndLineCode arg) {
+  obj.println();
+  return obj;
+}
+
+#endif
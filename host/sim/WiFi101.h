@@ -0,0 +1,74 @@
+/**
+ * \file WiFi101.h
+ * \brief Fake WiFi101 library for the host build
+ *
+ * The network is driven by the simulator (see simnet.h): the access point can
+ * be reachable or not and the join takes a configurable time. As the real
+ * library begin() waits for the connection until the timeout set with
+ * setTimeout(), moving the virtual clock forward; with a zero timeout it
+ * returns immediately and the connection is completed while status() is
+ * polled.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _WIFI101_SIM
+#define _WIFI101_SIM
+
+#include "Arduino.h"
+
+#define WL_IDLE_STATUS 0
+#define WL_NO_SSID_AVAIL 1
+#define WL_CONNECTED 3
+#define WL_CONNECT_FAILED 4
+#define WL_CONNECTION_LOST 5
+#define WL_DISCONNECTED 6
+#define WL_NO_SHIELD 255
+
+//! IP address
+class IPAddress {
+  private:
+  uint8_t bytes[4];
+
+  public:
+  IPAddress();
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+  uint8_t operator[](int j) const;
+};
+
+//! Network client
+class Client : public Stream {
+  public:
+  virtual int connect(const char *host, uint16_t port);
+  virtual uint8_t connected();
+  virtual void stop();
+  size_t write(uint8_t b) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+};
+
+//! TCP client of the WiFi module
+class WiFiClient : public Client {
+};
+
+//! WiFi module
+class WiFiClass {
+  public:
+  int begin(const char *ssid, const char *pass);
+  uint8_t status();
+  void config(IPAddress ip);
+  void setTimeout(unsigned long ms);
+  unsigned long getTime();
+  void disconnect();
+  void lowPowerMode();
+  void maxLowPowerMode();
+  void noLowPowerMode();
+};
+
+extern WiFiClass WiFi;
+
+#endif
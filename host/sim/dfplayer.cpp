@@ -0,0 +1,249 @@
+/**
+ * \file dfplayer.cpp
+ * \brief Fake DFPlayer mini for the host build
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "dfplayer.h"
+
+#define DF_START 0x7E
+#define DF_VERSION 0xFF
+#define DF_LENGTH 0x06
+#define DF_END 0xEF
+
+#define DF_CMD_PLAY 0x03
+#define DF_CMD_VOLUME 0x06
+#define DF_CMD_START 0x0D
+#define DF_CMD_PAUSE 0x0E
+#define DF_CMD_FOLDER 0x0F
+#define DF_EVT_FINISHED 0x3D
+#define DF_EVT_ONLINE 0x3F
+#define DF_EVT_ERROR 0x40
+#define DF_EVT_ACK 0x41
+
+DFPlayerSim::DFPlayerSim() :
+  serial(NULL), busyPin(-1), online(false), frameLen(0), dropFrames(0),
+  trackLength(DFPLAYER_SIM_TRACK), seekTime(DFPLAYER_SIM_BUSY), track(0), playId(0), trackEnd(0), trackLeft(0), firstNote(0), vol(0) {}
+
+void DFPlayerSim::begin(SimSerial &s, int busy) {
+  serial = &s;
+  busyPin = busy;
+  serial->connect(this);
+  online = true;
+  frameLen = 0;
+  track = 0;
+  sim::setPin(busyPin, HIGH);
+}
+
+void DFPlayerSim::powerCycle(unsigned long bootMs) {
+  online = false;
+  track = 0;
+  playId++;
+  soundOff();
+  sim::at(millis() + bootMs, [this]() {
+    online = true;
+    send(DF_EVT_ONLINE, 0x02);
+  });
+}
+
+void DFPlayerSim::drop(int frames) {
+  dropFrames = frames;
+}
+
+void DFPlayerSim::setTrackLength(unsigned long ms) {
+  trackLength = ms;
+}
+
+void DFPlayerSim::setTrackLength(unsigned int t, unsigned long ms) {
+  lengths[t] = ms;
+}
+
+void DFPlayerSim::setSeekTime(unsigned long ms) {
+  seekTime = ms;
+}
+
+void DFPlayerSim::send(byte cmd, unsigned int param) {
+  uint8_t f[DFPLAYER_SIM_FRAME_LEN];
+  uint16_t sum = 0;
+  int j;
+
+  f[0] = DF_START;
+  f[1] = DF_VERSION;
+  f[2] = DF_LENGTH;
+  f[3] = cmd;
+  f[4] = 0;
+  f[5] = highByte(param);
+  f[6] = lowByte(param);
+  for(j = 1; j <= 6; j++) {
+    sum += f[j];
+  }
+  sum = 0 - sum;
+  f[7] = highByte(sum);
+  f[8] = lowByte(sum);
+  f[9] = DF_END;
+  serial->inject(f, DFPLAYER_SIM_FRAME_LEN);
+}
+
+void DFPlayerSim::receive(uint8_t b) {
+  uint16_t sum = 0;
+  int j;
+
+  if( (frameLen == 0) && (b != DF_START) ) {
+    return;
+  }
+  frame[frameLen++] = b;
+  if(frameLen < DFPLAYER_SIM_FRAME_LEN) {
+    return;
+  }
+  frameLen = 0;
+  if( (!online) || (dropFrames > 0) ) {
+    if(dropFrames > 0) {
+      dropFrames--;
+    }
+    return;
+  }
+  for(j = 1; j <= 6; j++) {
+    sum += frame[j];
+  }
+  sum = 0 - sum;
+  if( (frame[9] != DF_END) || (word(frame[7], frame[8]) != sum) ) {
+    sim::at(millis() + DFPLAYER_SIM_PROCESS, [this]() { send(DF_EVT_ERROR, 0); });
+    return;
+  }
+
+  byte cmd = frame[3];
+  unsigned int param = word(frame[5], frame[6]);
+  boolean ack = frame[4] != 0;
+  sim::at(millis() + DFPLAYER_SIM_PROCESS, [this, cmd, param, ack]() { execute(cmd, param, ack); });
+}
+
+void DFPlayerSim::execute(byte cmd, unsigned int param, boolean ack) {
+  DFPlayerCommand c;
+
+  if(!online) {
+    return;
+  }
+  c.time = millis();
+  c.cmd = cmd;
+  c.param = param;
+  commands.push_back(c);
+
+  switch(cmd) {
+    case DF_CMD_PLAY:
+      play(param);
+    break;
+    case DF_CMD_FOLDER:
+      play(param);
+    break;
+    case DF_CMD_VOLUME:
+      vol = param;
+    break;
+    case DF_CMD_PAUSE:
+      if( (track != 0) && (playId > 0) ) {
+        playId++;
+        trackLeft = (trackEnd > c.time) ? trackEnd - c.time : 0;
+        soundOff();
+      }
+    break;
+    case DF_CMD_START:
+      if( (track != 0) && (sim::getPin(busyPin) == HIGH) ) {
+        resume(0, trackLeft);
+      }
+    break;
+  }
+  if(ack) {
+    send(DF_EVT_ACK, 0);
+  }
+}
+
+void DFPlayerSim::play(unsigned int t) {
+  unsigned long length = trackLength;
+  unsigned long end = trackEnd;
+  boolean playing = (track != 0) && (sim::getPin(busyPin) == LOW);
+
+  if(lengths.count(t) > 0) {
+    length = lengths[t];
+  }
+  track = t;
+  if(!playing) {
+    soundOff();
+  }
+  resume(seekTime, length);
+  // The playing track ends before the new one is ready
+  if( (playing) && (end < millis() + seekTime) ) {
+    unsigned long id = playId;
+
+    sim::at(end, [this, id]() {
+      if(id == playId) {
+        soundOff();
+      }
+    });
+  }
+}
+
+void DFPlayerSim::resume(unsigned long wait, unsigned long length) {
+  unsigned long id = ++playId;
+
+  trackEnd = millis() + wait + length;
+  sim::at(millis() + wait, [this, id]() {
+    if(id != playId) {
+      return;
+    }
+    soundOn();
+    if(firstNote == 0) {
+      firstNote = millis();
+    }
+  });
+  sim::at(trackEnd, [this, id]() {
+    if(id != playId) {
+      return;
+    }
+    soundOff();
+    send(DF_EVT_FINISHED, track);
+    track = 0;
+  });
+}
+
+void DFPlayerSim::soundOn() {
+  DFPlayerSound s;
+
+  // Switching from the playing track, the busy pin stays low
+  if( (!sounds.empty()) && (sounds.back().end == 0) ) {
+    sounds.back().end = millis();
+  }
+  s.track = track;
+  s.start = millis();
+  s.end = 0;
+  sounds.push_back(s);
+  sim::setPin(busyPin, LOW);
+}
+
+void DFPlayerSim::soundOff() {
+  if( (!sounds.empty()) && (sounds.back().end == 0) ) {
+    sounds.back().end = millis();
+  }
+  sim::setPin(busyPin, HIGH);
+}
+
+const std::vector<DFPlayerCommand>& DFPlayerSim::getCommands() {
+  return commands;
+}
+
+const std::vector<DFPlayerSound>& DFPlayerSim::getSounds() {
+  return sounds;
+}
+
+unsigned int DFPlayerSim::getTrack() {
+  return track;
+}
+
+int DFPlayerSim::getVolume() {
+  return vol;
+}
+
+unsigned long DFPlayerSim::getFirstNote() {
+  return firstNote;
+}
@@ -0,0 +1,142 @@
+/**
+ * \file dfplayer.h
+ * \brief Fake DFPlayer mini for the host build
+ *
+ * The fake is connected to the simulated serial of the sketch and to its busy
+ * pin. It decodes the command frames (see the DFPlayer datasheet), answers
+ * with the acknowledge after the processing time, plays the tracks moving the
+ * busy pin (low while playing) and notifies the track end and the power on.
+ * A play received while a track is playing does not stop it: the player
+ * seeks the new file and switches to it when it is ready, or when the
+ * playing track ends. The commands received and the times the sound
+ * started and stopped are logged with their virtual time.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _DFPLAYER_SIM
+#define _DFPLAYER_SIM
+
+#include "sim.h"
+#include <map>
+#include <vector>
+
+#define DFPLAYER_SIM_PROCESS 20UL       ///< Default time (ms) to receive and execute a command
+#define DFPLAYER_SIM_BUSY 100UL         ///< Default time (ms) from a play command to the busy pin low
+#define DFPLAYER_SIM_TRACK 60000UL      ///< Default track length (ms)
+#define DFPLAYER_SIM_FRAME_LEN 10       ///< Frame length
+
+//! A command received by the fake player
+typedef struct {
+  unsigned long time;   ///< Time (ms) the command has been executed
+  byte cmd;             ///< Command ID
+  unsigned int param;   ///< Command parameter
+} DFPlayerCommand;
+
+//! A time the fake player has been playing
+typedef struct {
+  unsigned int track;   ///< Track played
+  unsigned long start;  ///< Time (ms) the busy pin went low
+  unsigned long end;    ///< Time (ms) the track ended or it has been stopped, 0 if playing
+} DFPlayerSound;
+
+//! Fake DFPlayer mini
+class DFPlayerSim : public SimDevice {
+  private:
+  //! Serial connected to the sketch
+  SimSerial *serial;
+  //! Busy pin
+  int busyPin;
+  //! True when the player accepts the commands
+  boolean online;
+  //! Incoming frame
+  uint8_t frame[DFPLAYER_SIM_FRAME_LEN];
+  int frameLen;
+  //! Frames to ignore, to test the retries
+  int dropFrames;
+  //! Commands executed
+  std::vector<DFPlayerCommand> commands;
+  //! Times the player has been playing
+  std::vector<DFPlayerSound> sounds;
+  //! Track lengths (ms) by track, the others last trackLength
+  std::map<unsigned int, unsigned long> lengths;
+  unsigned long trackLength;
+  //! Time (ms) from a play command to the busy pin low
+  unsigned long seekTime;
+  //! Track playing, 0 if none
+  unsigned int track;
+  //! Incremented by every play, to ignore the ends of the tracks interrupted
+  unsigned long playId;
+  //! Time (ms) the track playing ends
+  unsigned long trackEnd;
+  //! Time (ms) left of the paused track
+  unsigned long trackLeft;
+  //! Time (ms) the busy pin went low the first time, 0 if never
+  unsigned long firstNote;
+  //! Current volume
+  int vol;
+
+  //! Send a frame to the sketch
+  void send(byte cmd, unsigned int param);
+  //! Execute a complete frame
+  void execute(byte cmd, unsigned int param, boolean ack);
+  //! Start playing a track
+  void play(unsigned int t);
+  //! Set the busy pin low, playing the current track
+  void soundOn();
+  //! Set the busy pin high
+  void soundOff();
+  //! Play the current track for a time, then notify its end
+  void resume(unsigned long wait, unsigned long length);
+
+  public:
+  DFPlayerSim();
+
+  /**
+   * Connect the player to the sketch, already powered on and online
+   * @param s The serial of the sketch
+   * @param busy The busy pin
+   */
+  void begin(SimSerial &s, int busy);
+
+  /**
+   * Power cycle the player. It ignores the commands until it is online again,
+   * then it notifies the power on
+   * @param bootMs Time (ms) to initialize
+   */
+  void powerCycle(unsigned long bootMs);
+
+  //! Ignore the next frames, without the acknowledge
+  void drop(int frames);
+
+  //! Set the length (ms) of all the tracks
+  void setTrackLength(unsigned long ms);
+
+  //! Set the length (ms) of a track
+  void setTrackLength(unsigned int t, unsigned long ms);
+
+  //! Set the time (ms) from a play command to the busy pin low, as a
+  //! slow microSD card
+  void setSeekTime(unsigned long ms);
+
+  void receive(uint8_t b) override;
+
+  //! Get the commands executed
+  const std::vector<DFPlayerCommand>& getCommands();
+
+  //! Get the times the player has been playing
+  const std::vector<DFPlayerSound>& getSounds();
+
+  //! Get the track playing, 0 if none
+  unsigned int getTrack();
+
+  //! Get the current volume
+  int getVolume();
+
+  //! Get the time (ms) the first note has been played, 0 if never
+  unsigned long getFirstNote();
+};
+
+#endif
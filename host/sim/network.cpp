@@ -0,0 +1,504 @@
+/**
+ * \file network.cpp
+ * \brief Fake WiFi, TLS and MQTT libraries for the host build
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "simnet.h"
+#include "WiFi101.h"
+#include "ArduinoBearSSL.h"
+#include "ArduinoECCX08.h"
+#include "ArduinoMqttClient.h"
+#include "MQTT.h"
+#include <deque>
+
+WiFiClass WiFi;
+ArduinoBearSSLClass ArduinoBearSSL;
+ECCX08Class ECCX08;
+
+namespace {
+
+boolean apAvailable = true;
+unsigned long apJoin = SIM_WIFI_JOIN;
+boolean brokerAvailable = true;
+unsigned long brokerConnectTime = SIM_BROKER_CONNECT;
+
+//! WiFi module status (WL_xxx)
+uint8_t wifiStatus = WL_IDLE_STATUS;
+//! Time (ms) the running join ends
+unsigned long long joinEnd = 0;
+//! True while a join is running
+boolean joining = false;
+//! Max time (ms) WiFi.begin() waits for the connection
+unsigned long wifiTimeout = 60000UL;
+
+boolean brokerUp = false;
+std::deque<sim::MqttMessage> inbox;
+std::vector<sim::MqttMessage> outbox;
+sim::NetStats netStats;
+//! Time (ms) of the last client poll
+unsigned long lastPoll = 0;
+
+//! Complete the running join when its time has come
+void updateWiFi() {
+  if( (joining) && ((unsigned long long)millis() >= joinEnd) ) {
+    joining = false;
+    wifiStatus = apAvailable ? WL_CONNECTED : WL_CONNECT_FAILED;
+  }
+}
+
+} // namespace
+
+namespace sim {
+
+void resetNetwork() {
+  apAvailable = true;
+  apJoin = SIM_WIFI_JOIN;
+  brokerAvailable = true;
+  brokerConnectTime = SIM_BROKER_CONNECT;
+  wifiStatus = WL_IDLE_STATUS;
+  joining = false;
+  joinEnd = 0;
+  wifiTimeout = 60000UL;
+  brokerUp = false;
+  inbox.clear();
+  outbox.clear();
+  memset(&netStats, 0, sizeof(netStats));
+}
+
+void setWiFi(boolean available, unsigned long joinMs) {
+  apAvailable = available;
+  apJoin = joinMs;
+}
+
+void setBroker(boolean available, unsigned long connectMs) {
+  brokerAvailable = available;
+  brokerConnectTime = connectMs;
+  if(!available) {
+    brokerUp = false;
+  }
+}
+
+void dropWiFi() {
+  joining = false;
+  wifiStatus = WL_CONNECTION_LOST;
+  brokerUp = false;
+}
+
+boolean isWiFiConnected() {
+  updateWiFi();
+  return wifiStatus == WL_CONNECTED;
+}
+
+void sendMessage(const char *topic, const std::string &payload) {
+  MqttMessage msg;
+
+  msg.topic = topic;
+  msg.payload = payload;
+  inbox.push_back(msg);
+}
+
+std::vector<MqttMessage>& getPublished() {
+  return outbox;
+}
+
+NetStats getNetStats() {
+  return netStats;
+}
+
+void clearNetStats() {
+  memset(&netStats, 0, sizeof(netStats));
+}
+
+void brokerPolled() {
+  if( (netStats.polls > 0) && ((millis() - lastPoll) > netStats.maxPollGap) ) {
+    netStats.maxPollGap = millis() - lastPoll;
+  }
+  lastPoll = millis();
+  netStats.polls++;
+}
+
+void netBlock(unsigned long ms) {
+  if(ms > netStats.maxBlock) {
+    netStats.maxBlock = ms;
+  }
+  advance(ms);
+}
+
+boolean brokerConnect(unsigned long timeout) {
+  netStats.brokerConnects++;
+  if(!isWiFiConnected()) {
+    return false;
+  }
+  // The handshake blocks also when the broker refuses the connection
+  netBlock(min(brokerConnectTime, timeout));
+  brokerUp = brokerAvailable && (brokerConnectTime <= timeout) && isWiFiConnected();
+  return brokerUp;
+}
+
+boolean brokerConnected() {
+  if(!isWiFiConnected()) {
+    brokerUp = false;
+  }
+  return brokerUp;
+}
+
+void brokerDisconnect() {
+  brokerUp = false;
+}
+
+boolean nextMessage(MqttMessage &msg) {
+  if( (inbox.empty()) || (!brokerConnected()) ) {
+    return false;
+  }
+  msg = inbox.front();
+  inbox.pop_front();
+  return true;
+}
+
+void published(const std::string &topic, const std::string &payload, boolean ok) {
+  MqttMessage msg;
+
+  if(!ok) {
+    netStats.failedPublish++;
+    return;
+  }
+  msg.topic = topic;
+  msg.payload = payload;
+  outbox.push_back(msg);
+}
+
+} // namespace sim
+
+// ========================================== WiFi101
+
+IPAddress::IPAddress() {
+  memset(bytes, 0, sizeof(bytes));
+}
+
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  bytes[0] = a;
+  bytes[1] = b;
+  bytes[2] = c;
+  bytes[3] = d;
+}
+
+uint8_t IPAddress::operator[](int j) const {
+  return bytes[j & 3];
+}
+
+int Client::connect(const char *host, uint16_t port) {
+  return sim::isWiFiConnected() ? 1 : 0;
+}
+
+uint8_t Client::connected() {
+  return sim::isWiFiConnected() ? 1 : 0;
+}
+
+void Client::stop() {
+}
+
+size_t Client::write(uint8_t b) {
+  return 1;
+}
+
+int Client::available() {
+  return 0;
+}
+
+int Client::read() {
+  return -1;
+}
+
+int Client::peek() {
+  return -1;
+}
+
+int WiFiClass::begin(const char *ssid, const char *pass) {
+  unsigned long long start = millis();
+
+  netStats.wifiBegins++;
+  wifiStatus = WL_IDLE_STATUS;
+  joining = true;
+  joinEnd = start + apJoin;
+  // Wait for the connection until the timeout, as the real library
+  if(wifiTimeout > 0) {
+    sim::netBlock((unsigned long)(min(joinEnd, start + wifiTimeout) - start));
+  }
+  return status();
+}
+
+uint8_t WiFiClass::status() {
+  updateWiFi();
+  return wifiStatus;
+}
+
+void WiFiClass::config(IPAddress ip) {
+}
+
+void WiFiClass::setTimeout(unsigned long ms) {
+  wifiTimeout = ms;
+}
+
+unsigned long WiFiClass::getTime() {
+  if(status() != WL_CONNECTED) {
+    return 0;
+  }
+  return SIM_EPOCH + millis() / 1000;
+}
+
+void WiFiClass::disconnect() {
+  joining = false;
+  wifiStatus = WL_DISCONNECTED;
+  brokerUp = false;
+}
+
+void WiFiClass::lowPowerMode() {
+}
+
+void WiFiClass::maxLowPowerMode() {
+}
+
+void WiFiClass::noLowPowerMode() {
+}
+
+// ========================================== ArduinoBearSSL, ArduinoECCX08
+
+BearSSLClient::BearSSLClient(Client &c) : client(&c) {}
+
+void BearSSLClient::setEccSlot(int slot, const char cert[]) {
+}
+
+void ArduinoBearSSLClass::onGetTime(unsigned long (*callback)()) {
+}
+
+int ECCX08Class::begin() {
+  return 1;
+}
+
+// ========================================== ArduinoMqttClient
+
+MqttClient::MqttClient(Client &c) :
+  onMessageCallback(NULL), isConnected(false), connectTimeout(MQTT_CLIENT_CONNECT_TIMEOUT), txSize(0), txStarted(false), rxIndex(0) {}
+
+MqttClient::MqttClient(Client *c) :
+  onMessageCallback(NULL), isConnected(false), connectTimeout(MQTT_CLIENT_CONNECT_TIMEOUT), txSize(0), txStarted(false), rxIndex(0) {}
+
+void MqttClient::setId(const char *id) {
+}
+
+void MqttClient::setKeepAliveInterval(unsigned long ms) {
+}
+
+void MqttClient::onMessage(void (*callback)(int)) {
+  onMessageCallback = callback;
+}
+
+void MqttClient::setConnectionTimeout(unsigned long ms) {
+  connectTimeout = ms;
+}
+
+int MqttClient::connect(const char *host, uint16_t port) {
+  isConnected = sim::brokerConnect(connectTimeout);
+  return isConnected ? 1 : 0;
+}
+
+uint8_t MqttClient::connected() {
+  isConnected = isConnected && sim::brokerConnected();
+  return isConnected ? 1 : 0;
+}
+
+void MqttClient::stop() {
+  isConnected = false;
+  sim::brokerDisconnect();
+}
+
+int MqttClient::connectError() {
+  return isConnected ? 0 : -2;
+}
+
+void MqttClient::poll() {
+  sim::MqttMessage msg;
+
+  if(!connected()) {
+    return;
+  }
+  sim::brokerPolled();
+  while(sim::nextMessage(msg)) {
+    rxTopic = msg.topic;
+    rxPayload = msg.payload;
+    rxIndex = 0;
+    if(onMessageCallback != NULL) {
+      onMessageCallback(rxPayload.size());
+    }
+    rxIndex = rxPayload.size();
+  }
+}
+
+int MqttClient::subscribe(const char *topic, uint8_t qos) {
+  return connected() ? 1 : 0;
+}
+
+int MqttClient::beginMessage(const char *topic, unsigned long size, bool retain, uint8_t qos, bool dup) {
+  if(!connected()) {
+    return 0;
+  }
+  txTopic = topic;
+  txPayload.clear();
+  txSize = size;
+  txStarted = true;
+  return 1;
+}
+
+int MqttClient::beginMessage(const char *topic, bool retain, uint8_t qos, bool dup) {
+  return beginMessage(topic, 0UL, retain, qos, dup);
+}
+
+int MqttClient::endMessage() {
+  boolean ok;
+
+  if(!txStarted) {
+    return 0;
+  }
+  txStarted = false;
+  if(txSize > 0) {
+    ok = txPayload.size() == txSize;
+  } else {
+    // The bytes over the buffer have been lost, the message is sent truncated
+    ok = true;
+  }
+  sim::published(txTopic, txPayload, ok && connected());
+  return (ok && connected()) ? 1 : 0;
+}
+
+size_t MqttClient::write(uint8_t b) {
+  if(!txStarted) {
+    return 0;
+  }
+  if( (txSize == 0) && (txPayload.size() >= TX_PAYLOAD_BUFFER_SIZE) ) {
+    return 0;
+  }
+  txPayload.push_back((char)b);
+  return 1;
+}
+
+size_t MqttClient::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+
+  while( (n < size) && (write(buffer[n]) == 1) ) {
+    n++;
+  }
+  return n;
+}
+
+String MqttClient::messageTopic() {
+  return String(rxTopic);
+}
+
+int MqttClient::messageSize() {
+  return rxPayload.size();
+}
+
+int MqttClient::available() {
+  return rxPayload.size() - rxIndex;
+}
+
+int MqttClient::read() {
+  if(rxIndex >= rxPayload.size()) {
+    return -1;
+  }
+  return (uint8_t)rxPayload[rxIndex++];
+}
+
+int MqttClient::peek() {
+  if(rxIndex >= rxPayload.size()) {
+    return -1;
+  }
+  return (uint8_t)rxPayload[rxIndex];
+}
+
+void MqttClient::flush() {
+}
+
+// ========================================== MQTT (256dpi)
+
+//! Bytes of the publish packet besides the topic and the payload
+#define SIM_MQTT_OVERHEAD 8
+
+MQTTClient::MQTTClient(int size) : bufSize(size), callback(NULL), isConnected(false), timeout(1000) {}
+
+void MQTTClient::begin(const char hostname[], int port, Client &client) {
+}
+
+void MQTTClient::begin(const char hostname[], Client &client) {
+}
+
+void MQTTClient::onMessageAdvanced(MQTTClientCallbackAdvanced cb) {
+  callback = cb;
+}
+
+void MQTTClient::setTimeout(int ms) {
+  timeout = ms;
+}
+
+bool MQTTClient::connect(const char clientId[], bool skip) {
+  isConnected = sim::brokerConnect(timeout);
+  return isConnected;
+}
+
+bool MQTTClient::connected() {
+  isConnected = isConnected && sim::brokerConnected();
+  return isConnected;
+}
+
+void MQTTClient::disconnect() {
+  isConnected = false;
+  sim::brokerDisconnect();
+}
+
+bool MQTTClient::loop() {
+  sim::MqttMessage msg;
+  std::string topic;
+  std::string payload;
+
+  if(!connected()) {
+    return false;
+  }
+  sim::brokerPolled();
+  while(sim::nextMessage(msg)) {
+    topic = msg.topic;
+    payload = msg.payload;
+    if( (int)(topic.size() + payload.size() + SIM_MQTT_OVERHEAD) > bufSize ) {
+      // Dropped by the client, as the real library does
+      continue;
+    }
+    if(callback != NULL) {
+      callback(this, &topic[0], &payload[0], payload.size());
+    }
+  }
+  return true;
+}
+
+bool MQTTClient::subscribe(const char topic[], int qos) {
+  return connected();
+}
+
+bool MQTTClient::publish(const char topic[], const char payload[], int length) {
+  boolean ok = connected() &&
+               ((int)(strlen(topic) + length + SIM_MQTT_OVERHEAD) <= bufSize);
+
+  sim::published(topic, std::string(payload, length), ok);
+  return ok;
+}
+
+bool MQTTClient::publish(const char topic[], const char payload[]) {
+  return publish(topic, payload, strlen(payload));
+}
+
+int MQTTClient::lastError() {
+  return isConnected ? 0 : -1;
+}
@@ -0,0 +1,176 @@
+/**
+ * \file sim.h
+ * \brief Control of the simulated Arduino core, used by the host tests and tools
+ *
+ * The virtual clock starts at 0 and moves only when the simulator is asked to:
+ * advance() by the tests, delay() and yield() by the sketch, run() after every
+ * loop() by the loop cost. The events scheduled with at() (e.g. the PIR input
+ * changes, the fake devices answers) are executed in order when the clock
+ * reaches their time, so a sketch sleeping until an interrupt wakes at the
+ * right virtual time.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SIM
+#define _SIM
+
+#include "Arduino.h"
+#include <functional>
+#include <vector>
+
+#define SIM_WRITE_DIGITAL 'D'   ///< digitalWrite() record
+#define SIM_WRITE_ANALOG 'A'    ///< analogWrite() record
+#define SIM_WRITE_SERVO 'S'     ///< Servo write record
+#define SIM_LOOP_COST 200UL     ///< Default virtual duration (us) of a loop() run
+
+namespace sim {
+
+//! A write to an output, with its virtual time
+typedef struct {
+  unsigned long time;   ///< Time (ms) of the write
+  char kind;            ///< What has been written (SIM_WRITE_xxx)
+  int pin;              ///< The pin
+  int value;            ///< The value written
+} PinWrite;
+
+//! Status of a fake servo, by pin
+typedef struct {
+  boolean attached;         ///< True if the servo is attached
+  int value;                ///< Last value written, -1 if never written
+  unsigned long writes;     ///< Number of writes
+  unsigned long attaches;   ///< Number of times the servo has been attached
+} ServoState;
+
+//! Statistics of the loop() runs done by run()
+typedef struct {
+  unsigned long loops;      ///< Number of loop() runs
+  double wallNs;            ///< Host time (ns) spent in loop()
+  double maxWallNs;         ///< Longest loop() run (ns)
+  unsigned long maxGapUs;   ///< Longest virtual time (us) between the starts of two loop() runs
+} LoopStats;
+
+//! Heap allocations done by the simulated core (String)
+typedef struct {
+  unsigned long allocations;    ///< Number of allocations and reallocations
+  unsigned long bytes;          ///< Bytes allocated
+} HeapStats;
+
+/**
+ * Restart the simulation: clock to 0, pins, interrupts, servos, serials,
+ * scheduled events and network fakes to their power on state
+ */
+void reset();
+
+//! Current virtual time (us), without the 32 bits wrap
+unsigned long long now();
+
+/**
+ * Move the clock forward, executing the events due
+ * @param ms The time (ms) to advance
+ */
+void advance(unsigned long ms);
+
+/**
+ * Move the clock forward, executing the events due
+ * @param us The time (us) to advance
+ */
+void advanceMicros(unsigned long long us);
+
+/**
+ * Move the clock to a time, executing the events due. Nothing happens
+ * if the time is already passed
+ * @param ms The absolute virtual time (ms)
+ */
+void advanceTo(unsigned long long ms);
+
+/**
+ * Schedule an event
+ * @param ms The absolute virtual time (ms) of the event
+ * @param event The function executed at that time
+ */
+void at(unsigned long long ms, std::function<void()> event);
+
+/**
+ * Get the time (ms) of the next scheduled event
+ * @return false if nothing is scheduled
+ */
+boolean nextEvent(unsigned long long &ms);
+
+/**
+ * Set the level of an input pin, calling its interrupt if the level changes
+ * @param pin The pin
+ * @param level HIGH or LOW
+ */
+void setPin(int pin, int level);
+
+/**
+ * Set the level of an input pin at a time
+ * @param ms The absolute virtual time (ms)
+ * @param pin The pin
+ * @param level HIGH or LOW
+ */
+void setPinAt(unsigned long long ms, int pin, int level);
+
+//! Set the value read by analogRead() on a pin
+void setAnalog(int pin, int value);
+
+//! Get the level of a pin, as last written or set
+int getPin(int pin);
+
+//! Get the last value written with analogWrite() on a pin, -1 if never written
+int getAnalog(int pin);
+
+//! Get the outputs written, in order
+const std::vector<PinWrite>& getWrites();
+
+//! Forget the outputs written, e.g. after the setup
+void clearWrites();
+
+//! Enable or disable the outputs recording (enabled after reset())
+void recordWrites(boolean enable);
+
+//! Get the status of the servo attached to a pin
+ServoState getServo(int pin);
+
+/**
+ * Set the virtual time every loop() run lasts in run()
+ * @param us The loop duration (us)
+ */
+void setLoopCost(unsigned long us);
+
+/**
+ * Run loop() until the clock has advanced by a time. Every run moves the
+ * clock by the loop cost, more if the loop sleeps or waits
+ * @param ms The time (ms) to run
+ */
+void run(unsigned long ms);
+
+//! Get the statistics of the loop() runs
+LoopStats getLoopStats();
+
+//! Restart the statistics of the loop() runs, e.g. to measure a sequence
+void clearLoopStats();
+
+//! Get the heap allocations done by the simulated core
+HeapStats getHeapStats();
+
+// ========================================== Internals used by the fakes
+
+//! Count a heap allocation
+void heapAllocated(unsigned long bytes);
+
+//! Record an output write
+void recordWrite(char kind, int pin, int value);
+
+//! Update the status of a fake servo
+ServoState& servo(int pin);
+
+//! Restart the network fakes, called by reset()
+void resetNetwork();
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * \file simnet.h
+ * \brief Control of the simulated network: WiFi access point and MQTT broker
+ *
+ * The connection calls of the fakes move the virtual clock forward as long as
+ * the real calls would block; the longest blocking time is kept in the
+ * network statistics.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SIMNET
+#define _SIMNET
+
+#include "Arduino.h"
+#include <string>
+#include <vector>
+
+#define SIM_WIFI_JOIN 1500UL        ///< Default time (ms) to join the access point
+#define SIM_BROKER_CONNECT 300UL    ///< Default time (ms) to connect the broker (TLS handshake included)
+#define SIM_EPOCH 1558000000UL      ///< Network time (s) at the virtual time 0
+
+namespace sim {
+
+//! A MQTT message
+typedef struct {
+  std::string topic;    ///< The topic
+  std::string payload;  ///< The message payload
+} MqttMessage;
+
+//! Network fakes statistics
+typedef struct {
+  unsigned long wifiBegins;     ///< Number of WiFi.begin() calls
+  unsigned long brokerConnects; ///< Number of broker connection attempts
+  unsigned long maxBlock;       ///< Longest time (ms) a network call blocked
+  unsigned long failedPublish;  ///< Messages rejected or truncated by the client
+  unsigned long polls;          ///< Client polls (messages and keepalive) while connected
+  unsigned long maxPollGap;     ///< Longest time (ms) between two client polls
+} NetStats;
+
+/**
+ * Set the access point
+ * @param available True if the access point accepts the connection
+ * @param joinMs Time (ms) to join it
+ */
+void setWiFi(boolean available, unsigned long joinMs = SIM_WIFI_JOIN);
+
+/**
+ * Set the broker
+ * @param available True if the broker accepts the connection
+ * @param connectMs Time (ms) to connect it
+ */
+void setBroker(boolean available, unsigned long connectMs = SIM_BROKER_CONNECT);
+
+//! Drop the WiFi connection, as when the access point is lost
+void dropWiFi();
+
+//! Return true if the WiFi module is connected
+boolean isWiFiConnected();
+
+//! Queue a message from the broker, delivered at the next client poll
+void sendMessage(const char *topic, const std::string &payload);
+
+//! Get the messages published by the sketch
+std::vector<MqttMessage>& getPublished();
+
+//! Get the network fakes statistics
+NetStats getNetStats();
+
+//! Restart the network fakes statistics, e.g. to measure a sequence
+void clearNetStats();
+
+// ========================================== Internals used by the fakes
+
+//! Block the caller, moving the clock forward
+void netBlock(unsigned long ms);
+
+/**
+ * Connect the broker, blocking for the connection time
+ * @param timeout Max time (ms) the client waits, the connection fails if
+ * the broker takes longer
+ */
+boolean brokerConnect(unsigned long timeout);
+
+//! Return true while the broker connection is up
+boolean brokerConnected();
+
+//! Close the broker connection
+void brokerDisconnect();
+
+//! Count a client poll of the broker connection
+void brokerPolled();
+
+//! Get the next message from the broker
+boolean nextMessage(MqttMessage &msg);
+
+//! Keep a message published, or count it as failed
+void published(const std::string &topic, const std::string &payload, boolean ok);
+
+} // namespace sim
+
+#endif
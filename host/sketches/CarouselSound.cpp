@@ -0,0 +1,3 @@
+// The CarouselSound sketch, compiled as the Arduino IDE does
+#include "Arduino.h"
+#include "CarouselSound.ino"
@@ -0,0 +1,3 @@
+// The carousel sketch, compiled as the Arduino IDE does
+#include "Arduino.h"
+#include "carousel.ino"
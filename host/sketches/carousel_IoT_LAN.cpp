@@ -0,0 +1,3 @@
+// The carousel_IoT_LAN sketch, compiled as the Arduino IDE does
+#include "Arduino.h"
+#include "carousel_IoT_LAN.ino"
@@ -0,0 +1,187 @@
+/**
+ * \file bench_json.cpp
+ * \brief Json status publishing: the String concatenation of the original
+ * sketch against the JsonWriter streaming
+ *
+ * Both publishers write the same counters to a sink counting the bytes, many
+ * times. The heap allocations are counted by the simulated String and by the
+ * global operator new, the time in CPU cycles (TSC) where available.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "check.h"
+#include "accounting.h"
+#include "jsonwriter.h"
+#include <chrono>
+#include <new>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define BENCH_RUNS 100000UL   ///< Messages published by every publisher
+
+//! Heap allocated through operator new
+unsigned long newAllocations = 0;
+unsigned long newBytes = 0;
+
+void* operator new(size_t size) {
+  void *p = malloc(size);
+
+  if(p == NULL) {
+    throw std::bad_alloc();
+  }
+  newAllocations++;
+  newBytes += size;
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+//! Time stamp, in cycles where the CPU counter is available, else in ns
+unsigned long long cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//! Sink counting the bytes published, keeping the last message
+class CountPrint : public Print {
+  public:
+  unsigned long bytes = 0;
+  std::string last;
+  boolean keep = false;
+
+  size_t write(uint8_t b) override {
+    bytes++;
+    if(keep) {
+      last.push_back((char)b);
+    }
+    return 1;
+  }
+  using Print::write;
+};
+
+//! Counters as published by the original sketch
+typedef struct {
+  int detections;
+  unsigned long timerStart;
+  float timePlayedUntilNow;
+  float wheelRotations;
+  unsigned long numSpheres;
+} LegacyMessage;
+
+//! The original publishJsonIoTStatus(), to the sink instead of the MQTT client
+void publishLegacy(Print &out, LegacyMessage &statusIoT) {
+  String jPublish;
+
+  jPublish = String("{\n'detections': " + String(statusIoT.detections) +
+                    ",\n'minutes': " + String(statusIoT.timePlayedUntilNow) +
+                    ",\nrotations': " + String(statusIoT.wheelRotations) +
+                    ",\n'spheres': " + String(statusIoT.numSpheres) +
+                    "\n}");
+  out.print(jPublish);
+}
+
+//! The current publishJsonIoTStatus(), to the sink instead of the MQTT client
+void publishWriter(Print &out, Accounting &usage) {
+  JsonWriter json(out);
+
+  json.beginObject();
+  json.add("detections", usage.getDetections());
+  json.add("minutes", usage.getMinutes());
+  json.add("rotations", usage.getRotations());
+  json.add("spheres", usage.getSpheres());
+  json.endObject();
+}
+
+//! Cost of a publisher
+typedef struct {
+  double cycles;          ///< Cycles by message
+  double allocations;     ///< Heap allocations by message
+  double heapBytes;       ///< Heap bytes allocated by message
+  double bytes;           ///< Bytes published by message
+} BenchResult;
+
+//! Run a publisher and measure it
+template<class F>
+BenchResult bench(const char *name, CountPrint &out, F publish) {
+  BenchResult result;
+  sim::HeapStats heap = sim::getHeapStats();
+  unsigned long allocations = newAllocations;
+  unsigned long heapBytes = newBytes;
+  unsigned long long start = cycles();
+
+  for(unsigned long j = 0; j < BENCH_RUNS; j++) {
+    publish();
+  }
+  result.cycles = (double)(cycles() - start) / BENCH_RUNS;
+  result.allocations = (double)(sim::getHeapStats().allocations - heap.allocations +
+                                newAllocations - allocations) / BENCH_RUNS;
+  result.heapBytes = (double)(sim::getHeapStats().bytes - heap.bytes +
+                              newBytes - heapBytes) / BENCH_RUNS;
+  result.bytes = (double)out.bytes / BENCH_RUNS;
+  printf("%-10s %8.0f cycles %6.1f allocations %8.1f heap bytes %6.1f bytes by message\n",
+         name, result.cycles, result.allocations, result.heapBytes, result.bytes);
+  return result;
+}
+
+int main() {
+  Accounting usage;
+  LegacyMessage legacy;
+  CountPrint legacyOut;
+  CountPrint writerOut;
+  BenchResult legacyResult;
+  BenchResult writerResult;
+
+  sim::reset();
+  // A few months of use
+  usage.begin(0);
+  for(unsigned long t = 1; t <= 2000; t++) {
+    usage.update(WHEEL_CAROUSEL, true, t * 1000UL);
+    if((t % 60) == 0) {
+      usage.cycleEnd();
+    }
+  }
+  legacy.detections = (int)usage.getDetections();
+  legacy.timerStart = 0;
+  legacy.timePlayedUntilNow = usage.getMinutes();
+  legacy.wheelRotations = usage.getRotations();
+  legacy.numSpheres = usage.getSpheres();
+
+  legacyResult = bench("String", legacyOut, [&]() { publishLegacy(legacyOut, legacy); });
+  writerResult = bench("JsonWriter", writerOut, [&]() { publishWriter(writerOut, usage); });
+  printf("JsonWriter: %.1fx faster, %.0f heap bytes saved by message\n",
+         legacyResult.cycles / writerResult.cycles, legacyResult.heapBytes - writerResult.heapBytes);
+
+  // The concatenation allocates at every message, the writer never
+  CHECK(legacyResult.allocations > 0);
+  CHECK(writerResult.allocations == 0);
+  CHECK(writerResult.heapBytes == 0);
+
+  // The writer output is valid Json, with the same counters
+  writerOut.keep = true;
+  publishWriter(writerOut, usage);
+  printf("%s\n", writerOut.last.c_str());
+  CHECK(writerOut.last.find('\'') == std::string::npos);
+  CHECK(writerOut.last.front() == '{');
+  CHECK(writerOut.last.back() == '}');
+  CHECK(writerOut.last.find("\"detections\":33") != std::string::npos);
+  CHECK(writerOut.last.find("\"rotations\":") != std::string::npos);
+  CHECK(writerOut.last.find("\"spheres\":") != std::string::npos);
+
+  return checkResult();
+}
@@ -0,0 +1,41 @@
+/**
+ * \file check.h
+ * \brief Minimal checks for the host tests
+ *
+ * A failed check prints the condition and its line, the test goes on.
+ * The test main returns checkResult(), non zero if a check failed.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _CHECK
+#define _CHECK
+
+#include <stdio.h>
+
+//! Number of failed checks
+static int checkFailures = 0;
+
+//! Check a condition, printing it if it is false
+#define CHECK(cond) checkCondition((cond), #cond, __FILE__, __LINE__)
+
+inline void checkCondition(bool ok, const char *text, const char *file, int line) {
+  if(!ok) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+    checkFailures++;
+  }
+}
+
+//! Print the result of the test, return the main() exit code
+inline int checkResult() {
+  if(checkFailures > 0) {
+    printf("FAILED: %d checks\n", checkFailures);
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
+
+#endif
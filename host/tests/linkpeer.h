@@ -0,0 +1,93 @@
+/**
+ * \file linkpeer.h
+ * \brief The other end of the sound serial link, for the tests
+ *
+ * Connected to the link serial of a sketch, it decodes and keeps the frames
+ * sent by the sketch and sends frames to it, with the SoundLink class of the
+ * sketch under test (the protocol is the same on both boards). It can answer
+ * the status requests as the sound board does.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _LINKPEER
+#define _LINKPEER
+
+#include "sim.h"
+#include "soundlink.h"
+#include <string>
+#include <vector>
+
+//! Sound link peer
+class LinkPeer : public SimDevice {
+  private:
+  //! Serial of the sketch
+  SimSerial *serial;
+  //! Serial of the peer: receives the bytes of the sketch, keeps the bytes to send
+  SimSerial port;
+  //! Peer side of the link
+  SoundLink link;
+  //! Answer the status requests
+  boolean answerStatus;
+  //! Frames received
+  std::vector<LinkFrame> frames;
+
+  //! Send the frames written by the peer
+  void flush() {
+    std::string &out = port.output();
+
+    serial->inject((const uint8_t*)out.data(), out.size());
+    out.clear();
+  }
+
+  public:
+  /**
+   * Connect the peer to the sketch
+   * @param s The link serial of the sketch
+   * @param answer True to answer the status requests
+   */
+  void begin(SimSerial &s, boolean answer) {
+    serial = &s;
+    answerStatus = answer;
+    link.begin(port);
+    s.connect(this);
+  }
+
+  void receive(uint8_t b) override {
+    LinkFrame f;
+
+    port.inject(&b, 1);
+    while(link.read(f, millis())) {
+      frames.push_back(f);
+      if( (answerStatus) && (f.cmd == SOUND_CMD_STATUS) ) {
+        link.send(SOUND_EVT_STATUS, 0);
+        flush();
+      }
+    }
+  }
+
+  //! Send a frame to the sketch
+  void send(byte cmd, unsigned int param) {
+    link.send(cmd, param);
+    flush();
+  }
+
+  //! Get the frames received
+  std::vector<LinkFrame>& getFrames() {
+    return frames;
+  }
+
+  //! Find the last frame of a command, NULL if none
+  const LinkFrame* last(byte cmd) {
+    for(size_t j = frames.size(); j > 0; j--) {
+      if(frames[j - 1].cmd == cmd) {
+        return &frames[j - 1];
+      }
+    }
+    return NULL;
+  }
+};
+
+#endif
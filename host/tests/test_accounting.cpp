@@ -0,0 +1,128 @@
+/**
+ * \file test_accounting.cpp
+ * \brief Usage accounting: exact totals whatever the loop timing, and the
+ * counters of the carousel_IoT sketch replaying visitor cycles
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "check.h"
+#include "accounting.h"
+#include "statemachine.h"
+
+extern StateMachine carousel;
+extern Accounting usage;
+
+//! Run the accounting at a constant speed, updated every step (ms), or at
+//! random steps up to the step
+IoTmessage constantSpeed(int wheel, unsigned long duration, unsigned long step, boolean jitter) {
+  Accounting acc;
+  unsigned long t = 0;
+
+  acc.begin(0);
+  while(t < duration) {
+    t = min(t + (jitter ? (unsigned long)random(1, step + 1) : step), duration);
+    acc.update(wheel, true, t);
+  }
+  return acc.getCounters();
+}
+
+//! The totals don't depend on the loop timing, nothing is lost by the rounding
+void testLoopTiming() {
+  IoTmessage ref = constantSpeed(WHEEL_CAROUSEL, 3600000UL, 1, false);
+  IoTmessage counters;
+  unsigned long steps[] = { 7, SERVO_CYCLE, IDLE_MAX_SLEEP, 1000 };
+  Accounting acc;
+  size_t j;
+
+  // An hour at the carousel speed: WHEEL_RPM rotations by minute
+  printf("1 hour at the carousel speed: %lu rotations, %lu spheres, %lu minutes\n",
+         ref.wheelRotations, ref.numSpheres, ref.minutesPlayed);
+  CHECK(ref.minutesPlayed == 60);
+  CHECK(ref.playedMs == 0);
+  CHECK(ref.wheelRotations == (unsigned long)(60 * WHEEL_RPM));
+  CHECK(ref.numSpheres == (unsigned long)(60 * WHEEL_RPM * SPHERES_PER_ROTATION));
+
+  randomSeed(7);
+  for(j = 0; j < sizeof(steps) / sizeof(steps[0]); j++) {
+    counters = constantSpeed(WHEEL_CAROUSEL, 3600000UL, steps[j], false);
+    CHECK(memcmp(&counters, &ref, sizeof(ref)) == 0);
+    counters = constantSpeed(WHEEL_CAROUSEL, 3600000UL, steps[j], true);
+    CHECK(memcmp(&counters, &ref, sizeof(ref)) == 0);
+  }
+
+  // The rotation direction doesn't matter
+  counters = constantSpeed(2 * WHEEL_STOP - WHEEL_CAROUSEL, 3600000UL, SERVO_CYCLE, false);
+  CHECK(memcmp(&counters, &ref, sizeof(ref)) == 0);
+
+  // Stopped and not running: nothing is counted
+  acc.begin(0);
+  acc.update(WHEEL_STOP, false, 3600000UL);
+  CHECK(acc.getRotations() == 0);
+  CHECK(acc.getMinutes() == 0);
+  CHECK(acc.getSpheres() == 0);
+}
+
+//! Replay visitor cycles through the sketch. The rotations are checked
+//! against the speed written to the wheel servo, ramps included
+void testCycles() {
+  const int cycles = 5;
+  double units = 0;
+  unsigned long played = 0;
+  unsigned long start;
+  unsigned long t = 0;
+  int speed = WHEEL_STOP;
+  double rotations;
+  int j;
+
+  sim::reset();
+  sim::setPin(PIR_PIN, LOW);
+  setup();
+  sim::clearWrites();
+
+  for(j = 0; j < cycles; j++) {
+    sim::run(PRESENCE_COOLDOWN + 5000);
+    sim::setPin(PIR_PIN, HIGH);
+    sim::run(PIR_DEBOUNCE + 1);
+    start = millis();
+    CHECK(carousel.isPir());
+    sim::run((j + 1) * 7000UL);
+    sim::setPin(PIR_PIN, LOW);
+    while(carousel.isPir()) {
+      sim::run(1);
+    }
+    played += millis() - start;
+  }
+  sim::run(WHEEL_DECEL_TIME + 1000);
+
+  // Integrate the speed written to the wheel servo
+  for(size_t k = 0; k < sim::getWrites().size(); k++) {
+    const sim::PinWrite &w = sim::getWrites()[k];
+
+    if( (w.kind == SIM_WRITE_SERVO) && (w.pin == WHEEL_SERVO_PIN) ) {
+      units += (double)abs(speed - WHEEL_STOP) * (w.time - t);
+      t = w.time;
+      speed = w.value;
+    }
+  }
+  units += (double)abs(speed - WHEEL_STOP) * (millis() - t);
+  rotations = units / ACCOUNTING_ROTATION_UNITS;
+
+  printf("%d cycles: %.3f rotations (servo writes %.3f), %.3f minutes (played %.3f)\n",
+         cycles, usage.getRotations(), rotations, usage.getMinutes(), played / 60000.0);
+  CHECK(usage.getDetections() == (unsigned long)cycles);
+  CHECK(fabs(usage.getRotations() - rotations) < 0.01);
+  CHECK(usage.getSpheres() == (unsigned long)(usage.getRotations() * SPHERES_PER_ROTATION));
+  // The played time is counted while the cycle runs, within a loop
+  // interval at the start and at the end: the idle loop sleeps
+  CHECK(fabs(usage.getMinutes() - played / 60000.0) < (cycles * (IDLE_MAX_SLEEP + SERVO_CYCLE)) / 60000.0);
+}
+
+int main() {
+  testLoopTiming();
+  testCycles();
+  return checkResult();
+}
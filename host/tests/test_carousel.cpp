@@ -0,0 +1,58 @@
+/**
+ * \file test_carousel.cpp
+ * \brief Stand alone carousel sketch on the simulated core
+ *
+ * Runs a PIR cycle through setup() and loop(): the wheel starts and stops,
+ * the music trigger follows the cycle and the servos are detached when the
+ * carousel is idle. Prints the cost of the loop runs.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "check.h"
+#include "statemachine.h"
+
+extern StateMachine carousel;
+
+int main() {
+  sim::LoopStats stats;
+
+  sim::reset();
+  sim::setPin(PIR_PIN, LOW);
+  setup();
+
+  // Idle: the servos are detached, the music is stopped
+  sim::run(IDLE_DETACH_DELAY + 1000);
+  CHECK(!carousel.isPir());
+  CHECK(!sim::getServo(WHEEL_SERVO_PIN).attached);
+  CHECK(sim::getPin(MUSIC_TRIGGER_PIN) == HIGH);
+
+  // Motion detected: the cycle starts, the wheel ramps to the carousel speed
+  sim::setPin(PIR_PIN, HIGH);
+  sim::run(PIR_DEBOUNCE + WHEEL_ACCEL_TIME + 100);
+  CHECK(carousel.isPir());
+  CHECK(sim::getPin(MUSIC_TRIGGER_PIN) == LOW);
+  CHECK(sim::getServo(WHEEL_SERVO_PIN).attached);
+  CHECK(sim::getServo(WHEEL_SERVO_PIN).value == WHEEL_CAROUSEL);
+
+  // Nobody around: the cycle ends after the hold time, the wheel stops
+  sim::setPin(PIR_PIN, LOW);
+  sim::run(max(PRESENCE_HOLD, PRESENCE_MIN_CYCLE) + WHEEL_DECEL_TIME + 500);
+  CHECK(!carousel.isPir());
+  CHECK(sim::getPin(MUSIC_TRIGGER_PIN) == HIGH);
+  CHECK(sim::getServo(WHEEL_SERVO_PIN).value == WHEEL_STOP);
+
+  // Idle again, the servos are released
+  sim::run(IDLE_DETACH_DELAY + 1000);
+  CHECK(!sim::getServo(WHEEL_SERVO_PIN).attached);
+
+  stats = sim::getLoopStats();
+  printf("%lu loops in %lu virtual ms, %.0f ns per loop (max %.0f ns), %u writes\n",
+         stats.loops, millis(), stats.wallNs / stats.loops, stats.maxWallNs,
+         (unsigned int)sim::getWrites().size());
+
+  return checkResult();
+}
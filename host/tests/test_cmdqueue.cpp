@@ -0,0 +1,74 @@
+/**
+ * \file test_cmdqueue.cpp
+ * \brief Remote commands queue: order, coalescing and overflow
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "check.h"
+#include "cmdqueue.h"
+
+//! Build a command
+MqttCommand command(int id, int priority) {
+  MqttCommand cmd;
+
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.id = id;
+  cmd.priority = priority;
+  return cmd;
+}
+
+int main() {
+  CommandQueue queue;
+  MqttCommand cmd;
+  MqttCommand lights = command(MQTTCMD_LIGTHS, 0);
+  MqttCommand music = command(MQTTCMD_MUSIC, 0);
+  MqttCommand urgent = command(MQTTCMD_LIGTHS, 5);
+  MqttCommand run = command(MQTTCMD_RUN, 3);
+  int j;
+
+  // An adjacent duplicate is coalesced
+  CHECK(queue.push(lights));
+  CHECK(queue.push(lights));
+  CHECK(queue.size() == 1);
+  CHECK(queue.getCoalesced() == 1);
+
+  // A duplicate waiting behind another command is queued again
+  CHECK(queue.push(music));
+  CHECK(queue.push(lights));
+  CHECK(queue.size() == 3);
+  CHECK(queue.getCoalesced() == 1);
+
+  // The duplicate of the tail keeps the higher priority and moves forward
+  CHECK(queue.push(urgent));
+  CHECK(queue.size() == 3);
+  CHECK(queue.getCoalesced() == 2);
+  CHECK(queue.pop(cmd) && (cmd.id == MQTTCMD_LIGTHS) && (cmd.priority == 5));
+  CHECK(queue.pop(cmd) && (cmd.id == MQTTCMD_LIGTHS) && (cmd.priority == 0));
+  CHECK(queue.pop(cmd) && (cmd.id == MQTTCMD_MUSIC));
+  CHECK(queue.isEmpty());
+
+  // Priority order, then arrival order
+  CHECK(queue.push(lights));
+  CHECK(queue.push(run));
+  CHECK(queue.push(music));
+  CHECK(queue.pop(cmd) && (cmd.id == MQTTCMD_RUN));
+  CHECK(queue.pop(cmd) && (cmd.id == MQTTCMD_LIGTHS));
+  CHECK(queue.pop(cmd) && (cmd.id == MQTTCMD_MUSIC));
+
+  // Overflow: the new command with the same priority is dropped
+  for(j = 0; j < CMD_QUEUE_SIZE; j++) {
+    cmd = command((j % 2) ? MQTTCMD_LIGTHS : MQTTCMD_MUSIC, 0);
+    CHECK(queue.push(cmd));
+  }
+  cmd = command(MQTTCMD_SHOW, 0);
+  CHECK(!queue.push(cmd));
+  CHECK(queue.getDropped() == 1);
+  CHECK(queue.push(run));
+  CHECK(queue.size() == CMD_QUEUE_SIZE);
+  CHECK(queue.pop(cmd) && (cmd.id == MQTTCMD_RUN));
+
+  return checkResult();
+}
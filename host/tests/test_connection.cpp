@@ -0,0 +1,91 @@
+/**
+ * \file test_connection.cpp
+ * \brief carousel_IoT sketch: the WiFi and broker connections don't block
+ * the carousel
+ *
+ * The WiFi join is polled without blocking the loop, the broker connection
+ * (TLS handshake) blocks for at most MQTT_CONNECT_TIMEOUT and only while the
+ * carousel is idle.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "simnet.h"
+#include "check.h"
+#include "globals.h"
+#include "connection.h"
+#include "statemachine.h"
+
+extern StateMachine carousel;
+extern ConnectionManager connection;
+
+//! Run a visitor cycle, checking the broker is not connected meanwhile
+void visitor() {
+  unsigned long connects = sim::getNetStats().brokerConnects;
+  unsigned long start;
+
+  sim::setPin(PIR_PIN, HIGH);
+  start = millis();
+  sim::run(PIR_DEBOUNCE + SERVO_CYCLE);
+  // The cycle starts in time, nothing is blocking the loop
+  CHECK(carousel.isPir());
+  CHECK(millis() - start <= PIR_DEBOUNCE + 2 * SERVO_CYCLE);
+  sim::run(5000);
+  sim::setPin(PIR_PIN, LOW);
+  while(carousel.isPir()) {
+    sim::run(100);
+  }
+  CHECK(sim::getNetStats().brokerConnects == connects);
+}
+
+int main() {
+  ConnectionStats stats;
+
+  sim::reset();
+  sim::setPin(PIR_PIN, LOW);
+
+  // No access point: the joins time out without blocking
+  sim::setWiFi(false);
+  setup();
+  visitor();
+  sim::run(30000);
+  stats = connection.getStats();
+  printf("No WiFi: %lu attempts, %lu failures, max block %lu ms\n",
+         stats.wifiAttempts, stats.failures, sim::getNetStats().maxBlock);
+  CHECK(stats.wifiAttempts > 1);
+  CHECK(stats.failures == stats.wifiAttempts);
+  CHECK(stats.lastFailureState == CONN_WIFI_JOIN);
+  CHECK(sim::getNetStats().maxBlock == 0);
+  CHECK(!connection.isConnected());
+
+  // Slow join during a cycle: the broker is connected when the cycle ends
+  sim::setWiFi(true, 3000);
+  visitor();
+  CHECK(sim::getNetStats().maxBlock == 0);
+  sim::run(CONN_BACKOFF_MAX + 5000);
+  CHECK(connection.isConnected());
+  CHECK(sim::getNetStats().maxBlock == SIM_BROKER_CONNECT);
+
+  // Connection lost and broker slower than the timeout: the attempts
+  // block for MQTT_CONNECT_TIMEOUT and fail
+  sim::setBroker(true, MQTT_CONNECT_TIMEOUT + 1000);
+  sim::dropWiFi();
+  visitor();
+  sim::run(30000);
+  stats = connection.getStats();
+  printf("Slow broker: %lu broker attempts, %lu failures, max block %lu ms\n",
+         stats.mqttAttempts, stats.failures, sim::getNetStats().maxBlock);
+  CHECK(!connection.isConnected());
+  CHECK(stats.lastFailureState == CONN_MQTT);
+  CHECK(sim::getNetStats().maxBlock == MQTT_CONNECT_TIMEOUT);
+
+  // The broker is back
+  sim::setBroker(true);
+  sim::run(CONN_BACKOFF_MAX + 5000);
+  CHECK(connection.isConnected());
+
+  return checkResult();
+}
@@ -0,0 +1,156 @@
+/**
+ * \file test_flashlog.cpp
+ * \brief Flash log on the simulated flash region: restore after the power
+ * cycles, wear leveling, interrupted writes and corrupted records
+ *
+ * A power cycle is a new FlashLog object reading the same region.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "check.h"
+#include "flashlog.h"
+
+//! Saved data, as the lifetime counters
+typedef struct {
+  unsigned long count;
+  unsigned long check;
+} Data;
+
+FlashRegion region;
+
+//! Erase the whole region, as a new board
+void eraseAll() {
+  int j;
+
+  for(j = 0; j < FLASHLOG_ROWS; j++) {
+    region.eraseRow(j * FLASHLOG_ROW_SIZE);
+  }
+}
+
+//! Save a version of the data
+boolean save(FlashLog &log, unsigned long count) {
+  Data data;
+
+  data.count = count;
+  data.check = ~count;
+  return log.append(&data, sizeof(data));
+}
+
+//! Restore the data after a power cycle, 0 if nothing is restored
+unsigned long restore() {
+  FlashLog log;
+  Data data;
+
+  if( (!log.begin()) || (!log.read(&data, sizeof(data))) || (data.check != ~data.count) ) {
+    return 0;
+  }
+  return data.count;
+}
+
+//! Count the pages written in the region
+int writtenPages() {
+  uint8_t page[FLASHLOG_PAGE_SIZE];
+  int count = 0;
+  int j, k;
+
+  for(j = 0; j < FLASHLOG_RECORDS; j++) {
+    region.read(j * FLASHLOG_PAGE_SIZE, page, FLASHLOG_PAGE_SIZE);
+    for(k = 0; (k < FLASHLOG_PAGE_SIZE) && (page[k] == 0xFF); k++) { }
+    if(k < FLASHLOG_PAGE_SIZE) {
+      count++;
+    }
+  }
+  return count;
+}
+
+//! Empty region, then many saves wrapping around the region
+void testWrap() {
+  FlashLog log;
+  unsigned long count;
+
+  eraseAll();
+  CHECK(!log.begin());
+  CHECK(restore() == 0);
+
+  for(count = 1; count <= 3 * FLASHLOG_RECORDS + 5; count++) {
+    CHECK(save(log, count));
+    CHECK(restore() == count);
+    // The pages are used in turn: none is written twice
+    // before the whole region has been used
+    if(count <= FLASHLOG_RECORDS) {
+      CHECK(writtenPages() == (int)count);
+    }
+  }
+  CHECK(log.getSequence() == 3 * FLASHLOG_RECORDS + 5);
+
+  // Too long data is refused and the log is unchanged
+  uint8_t tooLong[FLASHLOG_DATA_SIZE + 1];
+  memset(tooLong, 0, sizeof(tooLong));
+  CHECK(!log.append(tooLong, sizeof(tooLong)));
+  CHECK(restore() == 3 * FLASHLOG_RECORDS + 5);
+}
+
+//! A power loss during a write leaves a partial record
+void testInterrupted() {
+  FlashLog log;
+  FlashRecord record;
+  int next;
+
+  eraseAll();
+  log.begin();
+  CHECK(save(log, 100));
+  CHECK(save(log, 101));
+
+  // Half of the next page written: the seq and length, not the data and
+  // the CRC. The previous record is restored
+  next = 2;
+  memset(&record, 0xFF, sizeof(record));
+  record.seq = 3;
+  record.length = sizeof(Data);
+  memset(record.data, 0, FLASHLOG_DATA_SIZE / 2);
+  region.writePage(next * FLASHLOG_PAGE_SIZE, &record);
+  CHECK(restore() == 101);
+
+  // After the power cycle the partial page is skipped
+  FlashLog rebooted;
+  CHECK(rebooted.begin());
+  CHECK(save(rebooted, 102));
+  CHECK(restore() == 102);
+  CHECK(writtenPages() == 4);
+}
+
+//! A corrupted record fails the CRC, the previous one is used
+void testCorrupted() {
+  FlashLog log;
+  uint8_t zeros[FLASHLOG_PAGE_SIZE];
+  unsigned long count;
+
+  eraseAll();
+  log.begin();
+  // The last record is the first of a row: the previous one
+  // is at the end of the previous row
+  for(count = 1; count <= FLASHLOG_ROW_PAGES + 1; count++) {
+    CHECK(save(log, count));
+  }
+  memset(zeros, 0, sizeof(zeros));
+  region.writePage(FLASHLOG_ROW_PAGES * FLASHLOG_PAGE_SIZE, zeros);
+  CHECK(restore() == FLASHLOG_ROW_PAGES);
+
+  // Saving again continues after the last valid sequence
+  FlashLog rebooted;
+  CHECK(rebooted.begin());
+  CHECK(rebooted.getSequence() == FLASHLOG_ROW_PAGES);
+  CHECK(save(rebooted, 500));
+  CHECK(restore() == 500);
+}
+
+int main() {
+  testWrap();
+  testInterrupted();
+  testCorrupted();
+  return checkResult();
+}
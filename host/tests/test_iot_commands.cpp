@@ -0,0 +1,101 @@
+/**
+ * \file test_iot_commands.cpp
+ * \brief carousel_IoT sketch: the remote commands received from the broker
+ * are run, every message is answered with the status
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "simnet.h"
+#include "check.h"
+#include "config.h"
+#include "globals.h"
+#include "connection.h"
+#include "statemachine.h"
+#include "sequencer.h"
+#include "linkpeer.h"
+
+extern StateMachine carousel;
+extern ConnectionManager connection;
+
+//! Count the status messages published
+unsigned long statusMessages() {
+  unsigned long count = 0;
+
+  for(size_t j = 0; j < sim::getPublished().size(); j++) {
+    if(sim::getPublished()[j].topic == MQTT_CLIENT_PUBLISHER) {
+      count++;
+    }
+  }
+  return count;
+}
+
+int main() {
+  sim::reset();
+  sim::setPin(PIR_PIN, LOW);
+  setup();
+  sim::run(5000);
+  CHECK(connection.isConnected());
+
+  // The sweep profile is applied immediately
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, MQTT_SWEEP_SINE);
+  sim::run(100);
+  CHECK(carousel.getSweepProfile() == SWEEP_SINE);
+  CHECK(statusMessages() == 1);
+
+  // The run command starts the lights and the music without any visitor
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, MQTT_RUN);
+  sim::run(2000);
+  CHECK(!carousel.isPir());
+  CHECK(!carousel.isIdle());
+  CHECK(sim::getPin(MUSIC_TRIGGER_PIN) == LOW);
+  CHECK(statusMessages() == 2);
+
+  // Not a command: only the status is published
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, "status");
+  sim::run(100);
+  CHECK(carousel.getSweepProfile() == SWEEP_SINE);
+  CHECK(statusMessages() == 3);
+
+  // A show received from remote can't drive the wheel out of the range
+  // between stopped and the carousel speed
+  const byte show[] = { SHOW_FRAME_MAGIC, 3,
+                        KEYFRAME(0, SHOW_TRACK_WHEEL, 200, 500),
+                        KEYFRAME(2000, SHOW_TRACK_WHEEL, 30, 500),
+                        KEYFRAME(4000, SHOW_TRACK_MUSIC, 0, 0) };
+  while( (!carousel.isIdle()) && (millis() < 300000UL) ) {
+    sim::run(100);
+  }
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, std::string((const char*)show, sizeof(show)));
+  sim::run(100);
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, MQTT_SHOW_USER);
+  sim::run(1000);
+  CHECK(carousel.getWheelTarget() == WHEEL_CAROUSEL);
+  CHECK(sim::getServo(WHEEL_SERVO_PIN).value == WHEEL_CAROUSEL);
+  sim::run(2000);
+  CHECK(carousel.getWheelTarget() == WHEEL_STOP);
+  CHECK(sim::getServo(WHEEL_SERVO_PIN).value == WHEEL_STOP);
+
+  // Music with a volume: the volume is sent to the sound board for the
+  // sequence only, then the board goes back to its trimmer
+  LinkPeer nano;
+  const byte music[] = { CMD_FRAME_MAGIC, MQTTCMD_MUSIC, 1, 0, 2, 20, 1 };
+  while( (!carousel.isIdle()) && (millis() < 600000UL) ) {
+    sim::run(100);
+  }
+  nano.begin(Serial1, true);
+  sim::run(2 * SOUND_LINK_POLL);
+  CHECK(carousel.isSoundLinked());
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, std::string((const char*)music, sizeof(music)));
+  sim::run(1000);
+  CHECK( (nano.last(SOUND_CMD_VOLUME) != NULL) && (nano.last(SOUND_CMD_VOLUME)->param == 20) );
+  while( (!carousel.isIdle()) && (millis() < 900000UL) ) {
+    sim::run(100);
+  }
+  CHECK( (nano.last(SOUND_CMD_VOLUME) != NULL) && (nano.last(SOUND_CMD_VOLUME)->param == 0) );
+
+  return checkResult();
+}
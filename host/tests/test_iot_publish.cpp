@@ -0,0 +1,89 @@
+/**
+ * \file test_iot_publish.cpp
+ * \brief carousel_IoT sketch: the telemetry and profile messages longer than
+ * the MQTT client payload buffer are published whole, and the loop time
+ * they report doesn't include the idle sleep
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "simnet.h"
+#include "check.h"
+#include "config.h"
+#include "globals.h"
+#include "ArduinoMqttClient.h"
+#include <string>
+
+//! True if a message looks like a complete Json object
+boolean isComplete(const std::string &payload) {
+  return (payload.size() > 0) && (payload[0] == '{') && (payload[payload.size() - 1] == '}');
+}
+
+//! Largest number following a key in a payload, 0 if none
+unsigned long maxAfter(const std::string &payload, const std::string &key) {
+  unsigned long value = 0;
+  size_t pos = 0;
+
+  while((pos = payload.find(key, pos)) != std::string::npos) {
+    pos += key.size();
+    value = max(value, strtoul(payload.c_str() + pos, NULL, 10));
+  }
+  return value;
+}
+
+int main() {
+  unsigned long telemetry = 0;
+  unsigned long profile = 0;
+  size_t longest = 0;
+  unsigned long loopTelemetry = 0;
+  unsigned long loopProfile = 0;
+
+  sim::reset();
+  sim::setWiFi(true);
+  // A quick broker, the connection doesn't block the loop for long
+  sim::setBroker(true, 5);
+  sim::setPin(PIR_PIN, LOW);
+  setup();
+
+  // A carousel cycle, sampled by the telemetry
+  sim::run(5000);
+  sim::setPin(PIR_PIN, HIGH);
+  sim::run(10000);
+  sim::setPin(PIR_PIN, LOW);
+  sim::run(max(PRESENCE_HOLD, PRESENCE_MIN_CYCLE) + PROFILE_DUMP_INTERVAL);
+
+  for(size_t j = 0; j < sim::getPublished().size(); j++) {
+    const sim::MqttMessage &msg = sim::getPublished()[j];
+
+    if(msg.topic == MQTT_CLIENT_TELEMETRY) {
+      telemetry++;
+      CHECK(isComplete(msg.payload));
+      CHECK(msg.payload.size() < TELEMETRY_BUFFER_SIZE);
+      longest = max(longest, msg.payload.size());
+      loopTelemetry = max(loopTelemetry, maxAfter(msg.payload, "\"loop\":"));
+    } else if(msg.topic == MQTT_CLIENT_PROFILE) {
+      profile++;
+      CHECK(msg.payload.size() < PROFILE_BUFFER_SIZE);
+      longest = max(longest, msg.payload.size());
+      loopProfile = max(loopProfile, maxAfter(msg.payload.substr(0, msg.payload.find('\n')), " max="));
+    }
+  }
+  printf("%lu telemetry and %lu profile messages, longest %u bytes\n",
+         telemetry, profile, (unsigned int)longest);
+  printf("Longest loop: telemetry %lu us, profile %lu us\n", loopTelemetry, loopProfile);
+
+  CHECK(telemetry > 0);
+  CHECK(profile > 0);
+  // Longer than the client payload buffer and not truncated
+  CHECK(longest > TX_PAYLOAD_BUFFER_SIZE);
+  CHECK(sim::getNetStats().failedPublish == 0);
+  // The loop time doesn't include the idle sleep
+  CHECK(loopTelemetry < IDLE_MAX_SLEEP * 1000UL / 2);
+  CHECK(loopProfile > 0);
+  CHECK(loopProfile < IDLE_MAX_SLEEP * 1000UL / 2);
+
+  return checkResult();
+}
@@ -0,0 +1,96 @@
+/**
+ * \file test_latency.cpp
+ * \brief carousel_IoT_LAN sketch: loop latency while the remote command
+ * sequences run
+ *
+ * The music, lights and run sequences are run whole. Meanwhile the loop
+ * should run every few ms, the MQTT client should be polled (messages and
+ * keepalive) and the PIR edges should be read.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "simnet.h"
+#include "check.h"
+#include "config.h"
+#include "globals.h"
+#include "connection.h"
+#include "statemachine.h"
+
+#define LATENCY_GAP_MAX 5UL         ///< Max time (ms) between two loop runs or two client polls
+#define LATENCY_SEQUENCE_MAX 120000UL ///< Max duration (ms) of a sequence
+
+extern StateMachine carousel;
+extern ConnectionManager connection;
+
+//! Run the sketch until the carousel is idle, return the time (ms) it took
+unsigned long waitIdle(unsigned long maxMs) {
+  unsigned long start = millis();
+
+  while( (!carousel.isIdle()) && ((millis() - start) < maxMs) ) {
+    sim::run(1);
+  }
+  return millis() - start;
+}
+
+//! Run a whole command sequence, with a PIR edge and a sweep command
+//! received in the middle
+void testSequence(const char *command, const char *sweep, int profile) {
+  unsigned long start;
+  unsigned long edge;
+  unsigned long ms;
+  sim::LoopStats loops;
+  sim::NetStats net;
+
+  waitIdle(LATENCY_SEQUENCE_MAX);
+  sim::clearLoopStats();
+  sim::clearNetStats();
+  start = millis();
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, command);
+  sim::run(2000);
+  CHECK(carousel.mqttIsRunning());
+
+  // A visitor: the edge is read, the sequence is not interrupted
+  edge = millis();
+  sim::setPin(PIR_PIN, HIGH);
+  sim::run(PIR_DEBOUNCE + LATENCY_GAP_MAX);
+  CHECK(carousel.getPirDetection() == edge);
+  CHECK(!carousel.isPir());
+  sim::setPin(PIR_PIN, LOW);
+
+  // A message is processed while the sequence runs
+  sim::sendMessage(MQTT_CLIENT_SUBSCRIBER, sweep);
+  sim::run(LATENCY_GAP_MAX);
+  CHECK(carousel.getSweepProfile() == profile);
+
+  waitIdle(LATENCY_SEQUENCE_MAX);
+  CHECK(carousel.isIdle());
+  ms = millis() - start;
+  loops = sim::getLoopStats();
+  net = sim::getNetStats();
+  printf("%s: %lu ms, %lu loops, max gap %lu us, %lu polls, max poll gap %lu ms\n",
+         command, ms, loops.loops, loops.maxGapUs, net.polls, net.maxPollGap);
+
+  CHECK(connection.isConnected());
+  CHECK(loops.maxGapUs < LATENCY_GAP_MAX * 1000UL);
+  CHECK(net.polls >= ms / LATENCY_GAP_MAX);
+  CHECK(net.maxPollGap < LATENCY_GAP_MAX);
+  CHECK(net.maxBlock == 0);
+}
+
+int main() {
+  sim::reset();
+  sim::setPin(PIR_PIN, LOW);
+  setup();
+  sim::run(5000);
+  CHECK(connection.isConnected());
+
+  testSequence(MQTT_MUSIC, MQTT_SWEEP_SINE, SWEEP_SINE);
+  testSequence(MQTT_LIGTHS, MQTT_SWEEP_DWELL, SWEEP_DWELL);
+  testSequence(MQTT_RUN, MQTT_SWEEP_LINEAR, SWEEP_LINEAR);
+
+  return checkResult();
+}
@@ -0,0 +1,157 @@
+/**
+ * \file test_player.cpp
+ * \brief CarouselSound sketch with the fake DFPlayer: time from the boot,
+ * the trigger and the player reset to the first note, also when the player
+ * misses some commands, the volume set by the carousel board and the
+ * silence between the playlist tracks
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "check.h"
+#include "dfplayer.h"
+#include "globals.h"
+#include "linkpeer.h"
+#include "playlist.h"
+#include <SoftwareSerial.h>
+
+#define FIRST_NOTE_MAX 1000UL   ///< Max time (ms) to the first note
+#define TRACK_LENGTH 3000UL     ///< Length (ms) of the tracks of the playlist test
+#define TRACK_SEEK 800UL        ///< Time (ms) the player takes to start a track, slow card
+#define TRACK_SILENCE_MAX 5UL   ///< Max silence (ms) between two tracks of known length
+#define TRACK_CUT_MAX (PLAYLIST_PREISSUE + 50UL) ///< Max time (ms) cut from the end of a track
+#define TRACK_LEARN_MAX 200000UL ///< Max time (ms) to measure all the tracks
+
+DFPlayerSim dfplayer;
+LinkPeer carouselBoard;
+
+extern SoftwareSerial linkSerial;
+extern Playlist playlist;
+
+//! Run the sketch, keeping the link alive with the status requests
+void runLinked(unsigned long ms) {
+  unsigned long start = millis();
+
+  while((millis() - start) < ms) {
+    carouselBoard.send(SOUND_CMD_STATUS, 0);
+    sim::run(SOUND_LINK_TIMEOUT / 3);
+  }
+}
+
+//! Run the sketch until the player plays, return the time (ms) it took
+unsigned long waitNote(unsigned long maxMs) {
+  unsigned long start = millis();
+
+  while( (sim::getPin(BUSY_PIN) == HIGH) && ((millis() - start) < maxMs) ) {
+    sim::run(1);
+  }
+  return millis() - start;
+}
+
+int main() {
+  unsigned long ms;
+
+  sim::reset();
+  dfplayer.begin(Serial, BUSY_PIN);
+  dfplayer.setTrackLength(600000UL);
+  // The carousel is already asking for the music
+  sim::setPin(TRIGGER_PIN, LOW);
+
+  // Boot: the start parameters and the first song are queued together
+  setup();
+  sim::run(1);
+  ms = waitNote(5000);
+  printf("Boot to first note: %lu ms, %u commands\n", ms,
+         (unsigned int)dfplayer.getCommands().size());
+  CHECK(dfplayer.getFirstNote() > 0);
+  CHECK(dfplayer.getFirstNote() < FIRST_NOTE_MAX);
+
+  // Trigger released: the song fades out and the player is paused
+  sim::setPin(TRIGGER_PIN, HIGH);
+  sim::run(FADE_OUT_TIME + 1000);
+  CHECK(sim::getPin(BUSY_PIN) == HIGH);
+
+  // The player misses two commands: they are sent again after the
+  // acknowledge timeout and the song still starts in time
+  dfplayer.drop(2);
+  sim::setPin(TRIGGER_PIN, LOW);
+  ms = waitNote(5000);
+  printf("Trigger to note, 2 commands lost: %lu ms\n", ms);
+  CHECK(ms < FIRST_NOTE_MAX);
+
+  // The player resets while playing: the parameters are sent again and
+  // the song restarts as soon as the player is online
+  dfplayer.powerCycle(800);
+  sim::run(1);
+  CHECK(sim::getPin(BUSY_PIN) == HIGH);
+  sim::run(800);
+  ms = waitNote(5000);
+  printf("Player online to note: %lu ms\n", ms);
+  CHECK(ms < FIRST_NOTE_MAX);
+  CHECK(dfplayer.getVolume() > 0);
+
+  // The carousel board sets the volume, then the link is lost: the
+  // volume goes back to the trimmer
+  sim::setAnalog(ANALOG_FADE_PIN, 0);
+  carouselBoard.begin(linkSerial, false);
+  carouselBoard.send(SOUND_CMD_VOLUME, 25);
+  runLinked(FADE_DYNAMIC_TIME + 1000);
+  CHECK(dfplayer.getVolume() == 25);
+  sim::run(SOUND_LINK_TIMEOUT + FADE_DYNAMIC_TIME + 1000);
+  printf("Volume after the link loss: %d\n", dfplayer.getVolume());
+  CHECK(dfplayer.getVolume() == START_VOLUME);
+
+  // Trimmer half way: half of the player volume range
+  sim::setAnalog(ANALOG_FADE_PIN, 512);
+  sim::run(FADE_DYNAMIC_TIME + 2000);
+  printf("Volume with the trimmer half way: %d\n", dfplayer.getVolume());
+  CHECK(dfplayer.getVolume() == (int)map(512, 0, 1023, START_VOLUME, PLAYER_MAX_VOLUME));
+
+  // Short tracks on a slow card: every track is played to its end the
+  // first time and its length is measured
+  sim::setPin(TRIGGER_PIN, HIGH);
+  sim::run(FADE_OUT_TIME + 1000);
+  dfplayer.setTrackLength(TRACK_LENGTH);
+  dfplayer.setSeekTime(TRACK_SEEK);
+  sim::setPin(TRIGGER_PIN, LOW);
+  unsigned long start = millis();
+  int known = 0;
+  while( (known < NUMTRACKS) && ((millis() - start) < TRACK_LEARN_MAX) ) {
+    sim::run(1000);
+    for(known = 0; (known < NUMTRACKS) && (playlist.getLength(known) > 0); known++);
+  }
+  printf("All the tracks measured in %lu ms\n", millis() - start);
+  CHECK(known == NUMTRACKS);
+  Playlist reloaded;
+  reloaded.begin(false);
+  for(int j = 0; j < NUMTRACKS; j++) {
+    CHECK(playlist.getLength(j) >= TRACK_LENGTH - 2);
+    CHECK(playlist.getLength(j) <= TRACK_LENGTH + 2);
+    // Kept in the EEPROM for the next boot
+    CHECK(reloaded.getLength(j) == playlist.getLength(j));
+  }
+
+  // Then the next track is started before the end of the playing one:
+  // no silence between them and no track cut more than the margin. The
+  // last track measured has ended on the busy pin
+  size_t first = dfplayer.getSounds().size() + 1;
+  sim::run(10 * TRACK_LENGTH);
+  const std::vector<DFPlayerSound> &sounds = dfplayer.getSounds();
+  unsigned long silence = 0;
+  unsigned long shortest = TRACK_LENGTH;
+  for(size_t j = first; j < sounds.size() - 1; j++) {
+    silence = max(silence, sounds[j].start - sounds[j - 1].end);
+    shortest = min(shortest, sounds[j].end - sounds[j].start);
+    CHECK(sounds[j].track != sounds[j - 1].track);
+  }
+  printf("%u tracks, max silence %lu ms, shortest %lu ms\n",
+         (unsigned int)(sounds.size() - first), silence, shortest);
+  CHECK(sounds.size() - first >= 8);
+  CHECK(silence <= TRACK_SILENCE_MAX);
+  CHECK(shortest >= TRACK_LENGTH - TRACK_CUT_MAX);
+
+  return checkResult();
+}
@@ -0,0 +1,70 @@
+/**
+ * \file test_power.cpp
+ * \brief Idle power management of the stand alone carousel sketch: wake
+ * latency and active time report over hours of visitors
+ *
+ * The visitors arrive at random times, also in the middle of the sleeps. The
+ * report compares the time the processor has been active with the time the
+ * carousel has been running.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sim.h"
+#include "check.h"
+#include "statemachine.h"
+
+#define POWER_TEST_HOURS 2UL    ///< Virtual duration of the test
+#define POWER_TEST_STEP 10UL    ///< Time (ms) between the checks of the carousel status
+
+extern StateMachine carousel;
+
+int main() {
+  unsigned long end = POWER_TEST_HOURS * 3600000UL;
+  unsigned long long t = 0;
+  unsigned long visitors = 0;
+  unsigned long running = 0;
+  unsigned long active;
+  PowerStats power;
+  sim::LoopStats loops;
+
+  sim::reset();
+  sim::setPin(PIR_PIN, LOW);
+  setup();
+
+  // A visitor every 3 to 20 minutes, moving for 5 to 60 s, at any ms
+  randomSeed(19);
+  for(t = random(60000, 180000); t + 120000UL < end; t += random(180000, 1200000)) {
+    sim::setPinAt(t, PIR_PIN, HIGH);
+    sim::setPinAt(t + random(5000, 60000), PIR_PIN, LOW);
+    visitors++;
+  }
+
+  while(millis() < end) {
+    sim::run(POWER_TEST_STEP);
+    if(!carousel.isIdle()) {
+      running += POWER_TEST_STEP;
+    }
+  }
+
+  power = carousel.getPowerStats();
+  loops = sim::getLoopStats();
+  active = getActiveTime(power, millis());
+  printf("%lu h, %lu visitors: running %lu s, active %lu s (%.2f%%), sleeping %lu s\n",
+         POWER_TEST_HOURS, visitors, running / 1000, active / 1000,
+         100.0 * active / millis(), power.sleepTime / 1000);
+  printf("%lu sleeps, %lu wakeups, max wake latency %lu ms, %lu servo detaches, %lu loops\n",
+         power.sleeps, power.wakeups, power.maxWakeLatency, power.detaches, loops.loops);
+
+  // Every visitor arrives while sleeping and is noticed within a tick
+  CHECK(power.wakeups >= visitors);
+  CHECK(power.maxWakeLatency <= 1);
+  CHECK(power.detaches >= visitors);
+  // Awake only while the carousel runs, plus a loop for every sleep
+  CHECK(active <= running + (power.sleeps * SIM_LOOP_COST) / 1000 + visitors * POWER_TEST_STEP);
+  CHECK(active + power.sleepTime <= millis());
+
+  return checkResult();
+}
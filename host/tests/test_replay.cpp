@@ -0,0 +1,151 @@
+/**
+ * \file test_replay.cpp
+ * \brief Replay engine: sample log timeline and a month of events
+ *
+ * Usage: test_replay <sample log>
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "replay.h"
+#include "check.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+//! Print collecting the timeline
+class StringPrint : public Print {
+  public:
+  std::string text;
+  size_t write(uint8_t b) override { text.push_back((char)b); return 1; }
+  using Print::write;
+};
+
+//! Parse the printed timeline
+std::vector<Transition> parseTimeline(const std::string &text) {
+  std::vector<Transition> timeline;
+  Transition tr;
+  size_t pos = 0;
+
+  while(pos < text.size()) {
+    if(sscanf(text.c_str() + pos, "%lu %c %d", &tr.time, &tr.kind, &tr.value) == 3) {
+      timeline.push_back(tr);
+    }
+    pos = text.find('\n', pos);
+    if(pos == std::string::npos) {
+      break;
+    }
+    pos++;
+  }
+  return timeline;
+}
+
+//! Find the first transition of a kind after a time, NULL if none
+const Transition* find(const std::vector<Transition> &timeline, char kind, unsigned long from) {
+  for(size_t j = 0; j < timeline.size(); j++) {
+    if( (timeline[j].kind == kind) && (timeline[j].time >= from) ) {
+      return &timeline[j];
+    }
+  }
+  return NULL;
+}
+
+//! Replay the sample log
+void testSample(const char *path) {
+  FILE *log = fopen(path, "r");
+  StringPrint out;
+  Replay replay;
+  ReplayEvent e;
+  char line[256];
+  std::vector<Transition> timeline;
+  const Transition *tr;
+
+  CHECK(log != NULL);
+  if(log == NULL) {
+    return;
+  }
+  replay.begin(&out);
+  while(fgets(line, sizeof(line), log) != NULL) {
+    CHECK(Replay::parse(line, e));
+    replay.feed(e);
+  }
+  fclose(log);
+  replay.finish();
+  timeline = parseTimeline(out.text);
+
+  // The flicker doesn't start the carousel
+  tr = find(timeline, TRANSITION_PIR, 0);
+  CHECK( (tr != NULL) && (tr->time == 10000 + PIR_DEBOUNCE) && (tr->value == 1) );
+  // Wheel and music start with the cycle
+  tr = find(timeline, TRANSITION_WHEEL, 10000);
+  CHECK( (tr != NULL) && (tr->time == 10000 + PIR_DEBOUNCE) && (tr->value == WHEEL_CAROUSEL) );
+  tr = find(timeline, TRANSITION_MUSIC, 10000);
+  CHECK( (tr != NULL) && (tr->time == 10000 + PIR_DEBOUNCE) && (tr->value == 1) );
+  // The motion at 25 s holds the cycle until 26 s + PRESENCE_HOLD
+  tr = find(timeline, TRANSITION_PIR, 10000 + PIR_DEBOUNCE + 1);
+  CHECK( (tr != NULL) && (tr->value == 0) );
+  CHECK( (tr != NULL) && (tr->time >= 26000 + PRESENCE_HOLD) &&
+         (tr->time <= 26000 + PIR_DEBOUNCE + PRESENCE_HOLD + SERVO_CYCLE) );
+  tr = find(timeline, TRANSITION_WHEEL, 26000);
+  CHECK( (tr != NULL) && (tr->value == WHEEL_STOP) );
+  // The sweep profile selected from remote is used by the cycle
+  tr = find(timeline, TRANSITION_SWEEP, 0);
+  CHECK( (tr != NULL) && (tr->value == SWEEP_SINE) );
+  // Remote command
+  tr = find(timeline, TRANSITION_MQTT, 0);
+  CHECK( (tr != NULL) && (tr->time == 121000) && (tr->value == MQTTCMD_RUN) );
+  // The PIR doesn't start a cycle during the command
+  CHECK(find(timeline, TRANSITION_PIR, 121000) == NULL);
+  CHECK(replay.getStats().cycles == 1);
+  CHECK(replay.getStats().commands == 1);
+  CHECK(replay.getStats().lost == 0);
+  CHECK(replay.getMachine().isIdle());
+}
+
+//! Replay a month of visitors, generated
+void testMonth() {
+  Replay replay;
+  ReplayEvent e;
+  ReplayStats stats;
+  unsigned long t = 0;
+  unsigned long days = 30;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double wallMs;
+
+  replay.begin(NULL);
+  randomSeed(42);
+  e.kind = REPLAY_PIR;
+  while(t < days * 24UL * 3600000UL) {
+    // A visitor every 5 to 60 minutes, moving for 2 to 90 s
+    t += random(5, 60) * 60000UL;
+    e.time = t;
+    e.level = HIGH;
+    replay.feed(e);
+    e.time = t + random(2, 90) * 1000UL;
+    e.level = LOW;
+    replay.feed(e);
+  }
+  replay.finish();
+  stats = replay.getStats();
+  wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  printf("%lu days: %lu events, %lu cycles, %lu transitions, %lu steps in %.0f ms\n",
+         days, stats.events, stats.cycles, stats.transitions, stats.steps, wallMs);
+
+  // Every visitor starts a cycle, the gaps are longer than the cycles
+  CHECK(stats.cycles == stats.events / 2);
+  CHECK(stats.lost == 0);
+  CHECK(replay.getMachine().isIdle());
+  // A month in seconds
+  CHECK(wallMs < 30000.0);
+}
+
+int main(int argc, char *argv[]) {
+  CHECK(argc > 1);
+  if(argc > 1) {
+    testSample(argv[1]);
+  }
+  testMonth();
+  return checkResult();
+}
@@ -0,0 +1,68 @@
+/**
+ * \file accounting.cpp
+ * \brief Lifetime usage accounting of the carousel
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "accounting.h"
+
+void Accounting::begin(unsigned long now) {
+  memset(&counters, 0, sizeof(counters));
+  timerUpdate = now;
+}
+
+void Accounting::update(int wheel, boolean running, unsigned long now) {
+  unsigned long elapsed = now - timerUpdate;
+  unsigned long units;
+
+  timerUpdate = now;
+
+  // Speed by time, in any rotation direction
+  units = (unsigned long)abs(wheel - WHEEL_STOP) * elapsed;
+  counters.rotationUnits += units;
+  while(counters.rotationUnits >= ACCOUNTING_ROTATION_UNITS) {
+    counters.rotationUnits -= ACCOUNTING_ROTATION_UNITS;
+    counters.wheelRotations++;
+  }
+  // Same integration, every rotation passes SPHERES_PER_ROTATION spheres
+  counters.sphereUnits += units * SPHERES_PER_ROTATION;
+  while(counters.sphereUnits >= ACCOUNTING_ROTATION_UNITS) {
+    counters.sphereUnits -= ACCOUNTING_ROTATION_UNITS;
+    counters.numSpheres++;
+  }
+
+  if(running == true) {
+    counters.playedMs += elapsed;
+    while(counters.playedMs >= 60000UL) {
+      counters.playedMs -= 60000UL;
+      counters.minutesPlayed++;
+    }
+  }
+}
+
+void Accounting::cycleEnd() {
+  counters.detections++;
+}
+
+IoTmessage& Accounting::getCounters() {
+  return counters;
+}
+
+unsigned long Accounting::getDetections() {
+  return counters.detections;
+}
+
+float Accounting::getMinutes() {
+  return counters.minutesPlayed + counters.playedMs / 60000.0;
+}
+
+float Accounting::getRotations() {
+  return counters.wheelRotations + (float)counters.rotationUnits / ACCOUNTING_ROTATION_UNITS;
+}
+
+unsigned long Accounting::getSpheres() {
+  return counters.numSpheres;
+}
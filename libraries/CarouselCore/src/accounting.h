@@ -0,0 +1,89 @@
+/**
+ * \file accounting.h
+ * \brief Lifetime usage accounting of the carousel
+ * 
+ * The wheel rotations are calculated integrating the speed commanded to the
+ * wheel servo over the time, so the acceleration and deceleration ramps and
+ * any other speed are counted correctly. The integration is done in fixed
+ * point: every loop cycle adds the speed (servo units from WHEEL_STOP) by the
+ * elapsed milliseconds. A complete rotation is ACCOUNTING_ROTATION_UNITS of
+ * speed by time, and the rest is kept for the next cycles, so nothing is lost
+ * by the rounding and the totals are exact.
+ * 
+ * The played time is counted while the carousel cycle is running, in minutes
+ * plus the milliseconds of the current minute.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _ACCOUNTING
+#define _ACCOUNTING
+
+#include "Arduino.h"
+#include "globals.h"
+#include "structs.h"
+
+//! Speed by time (servo units by ms) of a complete wheel rotation: the
+//! wheel does WHEEL_RPM rotations in a minute at the WHEEL_CAROUSEL speed
+#define ACCOUNTING_ROTATION_UNITS ((unsigned long)(60000.0 * (WHEEL_CAROUSEL - WHEEL_STOP) / WHEEL_RPM + 0.5))
+
+//! Usage counters integrated over the time
+class Accounting {
+  private:
+  //! The counters, saved and restored as a whole
+  IoTmessage counters;
+  //! Time (ms) of the last update
+  unsigned long timerUpdate;
+
+  public:
+  /**
+   * Reset the counters and start counting
+   * 
+   * @param now The current time (ms)
+   */
+  void begin(unsigned long now);
+
+  /**
+   * Add the rotations and the played time since the last update.
+   * Should be called every loop cycle
+   * 
+   * @param wheel The speed commanded to the wheel servo
+   * @param running True if the carousel cycle is running
+   * @param now The current time (ms)
+   */
+  void update(int wheel, boolean running, unsigned long now);
+
+  /**
+   * Count a completed carousel cycle
+   */
+  void cycleEnd();
+
+  /**
+   * Get the counters, e.g. to save or restore them
+   */
+  IoTmessage& getCounters();
+
+  /**
+   * Get the number of detections
+   */
+  unsigned long getDetections();
+
+  /**
+   * Get the played time in minutes, including the current minute
+   */
+  float getMinutes();
+
+  /**
+   * Get the wheel rotations, including the current rotation
+   */
+  float getRotations();
+
+  /**
+   * Get the number of spheres passed
+   */
+  unsigned long getSpheres();
+};
+
+#endif
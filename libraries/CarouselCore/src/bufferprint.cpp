@@ -0,0 +1,42 @@
+/**
+ * \file bufferprint.cpp
+ * \brief Print stream writing to a fixed size buffer
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#include "bufferprint.h"
+
+BufferPrint::BufferPrint(char* buf, size_t bufSize) {
+  buffer = buf;
+  size = bufSize;
+  clear();
+}
+
+size_t BufferPrint::write(uint8_t c) {
+  if(length >= size) {
+    overflow = true;
+    return 0;
+  }
+  buffer[length++] = c;
+  return 1;
+}
+
+void BufferPrint::clear() {
+  length = 0;
+  overflow = false;
+}
+
+const char* BufferPrint::getBuffer() {
+  return buffer;
+}
+
+size_t BufferPrint::getLength() {
+  return length;
+}
+
+boolean BufferPrint::isOverflow() {
+  return overflow;
+}
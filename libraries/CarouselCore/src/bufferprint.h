@@ -0,0 +1,66 @@
+/**
+ * \file bufferprint.h
+ * \brief Print stream writing to a fixed size buffer
+ * 
+ * Used to prepare a message for the clients that need the whole payload at once
+ * (e.g. MQTTClient::publish()). The characters exceeding the buffer size are
+ * discarded and the overflow is reported.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _BUFFERPRINT
+#define _BUFFERPRINT
+
+#include "Arduino.h"
+
+//! Print stream on a fixed size buffer
+class BufferPrint : public Print {
+  private:
+  //! Destination buffer
+  char* buffer;
+  //! Buffer size
+  size_t size;
+  //! Number of characters written
+  size_t length;
+  //! True if some characters have been discarded
+  boolean overflow;
+
+  public:
+  /**
+   * @param buf The destination buffer
+   * @param bufSize The buffer size
+   */
+  BufferPrint(char* buf, size_t bufSize);
+
+  /**
+   * Add a character to the buffer
+   */
+  virtual size_t write(uint8_t c);
+
+  using Print::write;
+
+  /**
+   * Empty the buffer
+   */
+  void clear();
+
+  /**
+   * Get the buffer content
+   */
+  const char* getBuffer();
+
+  /**
+   * Get the number of characters in the buffer
+   */
+  size_t getLength();
+
+  /**
+   * Return true if some characters have been discarded
+   */
+  boolean isOverflow();
+};
+
+#endif
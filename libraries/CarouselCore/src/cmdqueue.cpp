@@ -0,0 +1,109 @@
+/**
+ * \file cmdqueue.cpp
+ * \brief Queue of the remote commands waiting to be executed
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "cmdqueue.h"
+
+CommandQueue::CommandQueue() {
+  head = 0;
+  count = 0;
+  dropped = 0;
+  coalesced = 0;
+}
+
+int CommandQueue::slot(int j) {
+  return (head + j) % CMD_QUEUE_SIZE;
+}
+
+void CommandQueue::remove(int j) {
+  // Shift the following commands back by one
+  for( ; j < count - 1; j++) {
+    commands[slot(j)] = commands[slot(j + 1)];
+  }
+  count--;
+}
+
+boolean CommandQueue::push(MqttCommand &cmd) {
+  int j;
+  MqttCommand* queued;
+
+  // Coalesce with an identical command at the tail of the queue. A command
+  // waiting behind a different one is queued again, the order is kept
+  if(count > 0) {
+    queued = &commands[slot(count - 1)];
+    if( (queued->id == cmd.id) && (queued->duration == cmd.duration) &&
+        (queued->level == cmd.level) && (queued->count == cmd.count) ) {
+      coalesced++;
+      if(queued->priority >= cmd.priority) {
+        return true;
+      }
+      // Keep the higher priority, the command moves forward
+      remove(count - 1);
+    }
+  }
+
+  if(count == CMD_QUEUE_SIZE) {
+#if CMD_QUEUE_OVERFLOW == CMD_OVERFLOW_DROP_OLD
+    // Drop the oldest command with the lowest priority
+    int lowest = count - 1;
+    for(j = count - 2; j >= 0; j--) {
+      if(commands[slot(j)].priority == commands[slot(lowest)].priority) {
+        lowest = j;
+      }
+    }
+    if(commands[slot(lowest)].priority > cmd.priority) {
+      // Everything in the queue is more important
+      dropped++;
+      return false;
+    }
+    remove(lowest);
+#else
+    // Drop the new command, unless it is more important than the last one
+    if(commands[slot(count - 1)].priority >= cmd.priority) {
+      dropped++;
+      return false;
+    }
+    remove(count - 1);
+#endif
+    dropped++;
+  }
+
+  // Insert after the commands with the same or higher priority
+  for(j = count; (j > 0) && (commands[slot(j - 1)].priority < cmd.priority); j--) {
+    commands[slot(j)] = commands[slot(j - 1)];
+  }
+  commands[slot(j)] = cmd;
+  count++;
+  return true;
+}
+
+boolean CommandQueue::pop(MqttCommand &cmd) {
+  if(count == 0) {
+    return false;
+  }
+  cmd = commands[head];
+  head = (head + 1) % CMD_QUEUE_SIZE;
+  count--;
+  return true;
+}
+
+boolean CommandQueue::isEmpty() {
+  return count == 0;
+}
+
+int CommandQueue::size() {
+  return count;
+}
+
+unsigned long CommandQueue::getDropped() {
+  return dropped;
+}
+
+unsigned long CommandQueue::getCoalesced() {
+  return coalesced;
+}
@@ -0,0 +1,91 @@
+/**
+ * \file cmdqueue.h
+ * \brief Queue of the remote commands waiting to be executed
+ * 
+ * The commands received while another command is running are kept in a fixed
+ * size circular buffer, ordered by priority and, with the same priority, by
+ * arrival. A command identical to the one at the tail of the queue (an
+ * adjacent duplicate) is coalesced with it, keeping the higher priority.
+ * When the queue is full the overflow policy (CMD_QUEUE_OVERFLOW) decides
+ * which command is dropped:
+ * - CMD_OVERFLOW_DROP_NEW the new command is dropped, unless it has a higher
+ *   priority than the last waiting command
+ * - CMD_OVERFLOW_DROP_OLD the oldest command with the lowest priority is dropped
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _CMDQUEUE
+#define _CMDQUEUE
+
+#include "Arduino.h"
+#include "globals.h"
+#include "structs.h"
+
+//! Remote commands priority queue
+class CommandQueue {
+  private:
+  //! Queued commands, from head (next to execute) to tail
+  MqttCommand commands[CMD_QUEUE_SIZE];
+  //! Index of the next command to execute
+  int head;
+  //! Number of queued commands
+  int count;
+  //! Commands dropped due the queue overflow
+  unsigned long dropped;
+  //! Commands coalesced with a queued one
+  unsigned long coalesced;
+
+  /**
+   * Return the buffer index of the j-th queued command
+   */
+  int slot(int j);
+
+  /**
+   * Remove the j-th queued command
+   */
+  void remove(int j);
+
+  public:
+  CommandQueue();
+
+  /**
+   * Add a command to the queue
+   * 
+   * @param cmd The command
+   * @return false if the command has been dropped
+   */
+  boolean push(MqttCommand &cmd);
+
+  /**
+   * Get the next command to execute
+   * 
+   * @param cmd Filled with the command, if any
+   * @return false if the queue is empty
+   */
+  boolean pop(MqttCommand &cmd);
+
+  /**
+   * Return true if there are no commands waiting
+   */
+  boolean isEmpty();
+
+  /**
+   * Return the number of commands waiting
+   */
+  int size();
+
+  /**
+   * Return the number of commands dropped due the queue overflow
+   */
+  unsigned long getDropped();
+
+  /**
+   * Return the number of commands coalesced with a queued one
+   */
+  unsigned long getCoalesced();
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * \file connection.cpp
+ * \brief Non blocking WiFi and MQTT connection manager
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "connection.h"
+
+void ConnectionManager::begin(ConnectionFunction wifiConn, ConnectionFunction wifiCheck,
+                              ConnectionFunction mqttConn, ConnectionFunction mqttCheck,
+                              ConnectionFunction connected, unsigned long now) {
+  wifiConnect = wifiConn;
+  wifiIsConnected = wifiCheck;
+  mqttConnect = mqttConn;
+  mqttIsConnected = mqttCheck;
+  onConnected = connected;
+  memset(&stats, 0, sizeof(stats));
+  state = CONN_WIFI;
+  timerRetry = now;
+  timerJoin = now;
+  waitTime = 0;
+  backoff = CONN_BACKOFF_MIN;
+}
+
+void ConnectionManager::failed(unsigned long now) {
+  stats.failures++;
+  stats.lastFailure = now;
+  stats.lastFailureState = state;
+  // Wait for the backoff time plus up to 50% of random jitter,
+  // so many units don't retry all together
+  timerRetry = now;
+  waitTime = backoff + random(backoff / 2 + 1);
+  backoff = min(backoff * 2, CONN_BACKOFF_MAX);
+}
+
+void ConnectionManager::update(unsigned long now, boolean canBlock) {
+  if(state == CONN_CONNECTED) {
+    if(wifiIsConnected() && mqttIsConnected()) {
+      return;
+    }
+    // Connection lost, try to reconnect immediately
+    stats.uptime += now - stats.connectedSince;
+    stats.lastFailure = now;
+    stats.lastFailureState = state;
+    state = CONN_WIFI;
+    waitTime = 0;
+    backoff = CONN_BACKOFF_MIN;
+  }
+
+  // Backing off
+  if( (now - timerRetry) < waitTime) {
+    return;
+  }
+
+  if(state == CONN_WIFI_JOIN) {
+    // Poll the join started by a previous call
+    if(!wifiIsConnected()) {
+      if( (now - timerJoin) >= WIFI_CONNECT_TIMEOUT) {
+        failed(now);
+        state = CONN_WIFI;
+      }
+      return;
+    }
+    state = CONN_MQTT;
+  } else if(!wifiIsConnected()) {
+    // Start the join, the WiFi module connects in background
+    state = CONN_WIFI;
+    stats.wifiAttempts++;
+    if(!wifiConnect()) {
+      failed(now);
+      return;
+    }
+    state = CONN_WIFI_JOIN;
+    timerJoin = now;
+    return;
+  }
+
+  // The broker connection blocks the loop, wait until it is allowed
+  state = CONN_MQTT;
+  if(!canBlock) {
+    return;
+  }
+  stats.mqttAttempts++;
+  if(!mqttConnect()) {
+    failed(now);
+    return;
+  }
+
+  // Connection established
+  state = CONN_CONNECTED;
+  stats.connections++;
+  stats.connectedSince = now;
+  waitTime = 0;
+  backoff = CONN_BACKOFF_MIN;
+  onConnected();
+}
+
+boolean ConnectionManager::isConnected() {
+  return state == CONN_CONNECTED;
+}
+
+ConnectionStats ConnectionManager::getStats() {
+  return stats;
+}
+
+unsigned long ConnectionManager::getUptime(unsigned long now) {
+  if(state == CONN_CONNECTED) {
+    return stats.uptime + (now - stats.connectedSince);
+  }
+  return stats.uptime;
+}
+
+void ConnectionManager::write(JsonWriter &json, const char* key, unsigned long now) {
+  json.beginObject(key);
+  json.add("wifiAttempts", stats.wifiAttempts);
+  json.add("mqttAttempts", stats.mqttAttempts);
+  json.add("failures", stats.failures);
+  json.add("connections", stats.connections);
+  json.add("uptime", getUptime(now));
+  json.add("lastFailure", stats.lastFailure);
+  json.add("lastFailureState", stats.lastFailureState);
+  json.endObject();
+}
@@ -0,0 +1,134 @@
+/**
+ * \file connection.h
+ * \brief Non blocking WiFi and MQTT connection manager
+ *
+ * The connection is managed as a state machine advanced every loop cycle: at
+ * most one connection step is done every call, and after a failure the next
+ * attempt is delayed with an exponential backoff, from CONN_BACKOFF_MIN to
+ * CONN_BACKOFF_MAX ms, plus a random jitter. Between the attempts the loop
+ * continues normally, so the carousel keeps working with the PIR sensor while
+ * the network is not available.
+ *
+ * The WiFi connection doesn't block: the join is started by one call and
+ * polled by the next ones, up to WIFI_CONNECT_TIMEOUT. The MQTT broker
+ * connection (TLS handshake included) can't be split by the libraries and
+ * blocks up to MQTT_CONNECT_TIMEOUT, so it is attempted only when the sketch
+ * allows it, e.g. while the carousel is idle.
+ *
+ * The manager doesn't depend on the network libraries: the sketch provides
+ * the functions to connect and to check the WiFi and the MQTT client.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _CONNECTION
+#define _CONNECTION
+
+#include "Arduino.h"
+#include "globals.h"
+#include "jsonwriter.h"
+
+//! Connection attempt or check function. Returns true on success
+typedef boolean (*ConnectionFunction)();
+
+//! Connection statistics
+typedef struct {
+  unsigned long wifiAttempts;    ///< Number of WiFi connection attempts
+  unsigned long mqttAttempts;    ///< Number of MQTT broker connection attempts
+  unsigned long failures;        ///< Number of failed attempts
+  unsigned long connections;     ///< Number of successful connections
+  unsigned long uptime;          ///< Total time (ms) connected, excluding the current connection
+  unsigned long connectedSince;  ///< Time (ms) of the last successful connection
+  unsigned long lastFailure;     ///< Time (ms) of the last failure or connection loss
+  int lastFailureState;          ///< Connection state (CONN_xxx) of the last failure
+} ConnectionStats;
+
+//! WiFi and MQTT connection manager
+class ConnectionManager {
+  private:
+  //! Start the connection to the WiFi network
+  ConnectionFunction wifiConnect;
+  //! Check the WiFi connection
+  ConnectionFunction wifiIsConnected;
+  //! Connect to the MQTT broker
+  ConnectionFunction mqttConnect;
+  //! Check the MQTT broker connection
+  ConnectionFunction mqttIsConnected;
+  //! Called after the connection, e.g. to subscribe the topics
+  ConnectionFunction onConnected;
+
+  //! Connection state
+  int state;
+  //! Time (ms) of the last failure
+  unsigned long timerRetry;
+  //! Time (ms) the WiFi join started
+  unsigned long timerJoin;
+  //! Time (ms) to wait before the next attempt
+  unsigned long waitTime;
+  //! Current backoff time (ms), doubled on every failure
+  unsigned long backoff;
+  //! Connection statistics
+  ConnectionStats stats;
+
+  /**
+   * Register a failed attempt and schedule the next one
+   */
+  void failed(unsigned long now);
+
+  public:
+  /**
+   * Initialize the connection manager. The first attempt is done
+   * by the first update() call
+   * 
+   * @param wifiConn Start the connection to the WiFi network, without waiting
+   * for it. Returns false if the connection can't be started
+   * @param wifiCheck Check the WiFi connection
+   * @param mqttConn Connect to the MQTT broker
+   * @param mqttCheck Check the MQTT broker connection
+   * @param connected Called when the connection is established
+   * @param now The current time (ms)
+   */
+  void begin(ConnectionFunction wifiConn, ConnectionFunction wifiCheck,
+             ConnectionFunction mqttConn, ConnectionFunction mqttCheck,
+             ConnectionFunction connected, unsigned long now);
+
+  /**
+   * Check the connection and, if it is time, do the next connection step.
+   * Should be called every loop cycle
+   * 
+   * @param now The current time (ms)
+   * @param canBlock True if the broker connection, that blocks the loop,
+   * can be attempted now
+   */
+  void update(unsigned long now, boolean canBlock);
+
+  /**
+   * Return true if both the WiFi and the MQTT broker are connected
+   */
+  boolean isConnected();
+
+  /**
+   * Get the connection statistics
+   */
+  ConnectionStats getStats();
+
+  /**
+   * Get the total time connected, including the current connection
+   * 
+   * @param now The current time (ms)
+   */
+  unsigned long getUptime(unsigned long now);
+
+  /**
+   * Write the connection statistics as a Json object
+   * 
+   * @param json The Json writer
+   * @param key The object key
+   * @param now The current time (ms)
+   */
+  void write(JsonWriter &json, const char* key, unsigned long now);
+};
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * \file fader.cpp
+ * \brief Lights fade engine
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "fader.h"
+#include "gamma.h"
+
+void LightFader::begin(int level) {
+  int j;
+  for(j = 0; j < NUMLIGHTS; j++) {
+    channels[j].begin(constrain(level, 0, 255));
+  }
+}
+
+void LightFader::setChannel(int j, int level, unsigned long ms, unsigned long now) {
+  channels[j].setTarget(constrain(level, 0, 255), ms, RAMP_LINEAR, now);
+}
+
+void LightFader::setAll(int level, unsigned long ms, unsigned long now) {
+  int j;
+  for(j = 0; j < NUMLIGHTS; j++) {
+    setChannel(j, level, ms, now);
+  }
+}
+
+void LightFader::update(Outputs &out, unsigned long now) {
+  int j;
+  for(j = 0; j < NUMLIGHTS; j++) {
+    out.writeLight(j, pgm_read_byte(&gammaTable[channels[j].update(now)]));
+  }
+}
+
+int LightFader::getChannel(int j) {
+  return channels[j].getValue();
+}
+
+boolean LightFader::isRunning() {
+  int j;
+  for(j = 0; j < NUMLIGHTS; j++) {
+    if(channels[j].isRunning()) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,78 @@
+/**
+ * \file fader.h
+ * \brief Lights fade engine
+ * 
+ * Every light channel has its own level ramp, so the channels can fade
+ * independently to different targets (dissolves, chases). The levels are
+ * perceptual levels: the PWM value written to the lights is read from the
+ * gamma table. Every update is just a ramp calculation and a table read per
+ * channel, and only the changed PWM values reach the hardware.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _FADER
+#define _FADER
+
+#include "Arduino.h"
+#include "globals.h"
+#include "ramp.h"
+#include "outputs.h"
+
+//! Lights fade engine
+class LightFader {
+  private:
+  //! Level ramp of every light channel
+  Ramp channels[NUMLIGHTS];
+
+  public:
+  /**
+   * Set all the channels to the same level immediately
+   * 
+   * @param level The perceptual light level (0-255)
+   */
+  void begin(int level);
+
+  /**
+   * Start the fade of a channel
+   * 
+   * @param j The light channel
+   * @param level The target perceptual level (0-255)
+   * @param ms The fade duration (ms)
+   * @param now The current time (ms)
+   */
+  void setChannel(int j, int level, unsigned long ms, unsigned long now);
+
+  /**
+   * Start the fade of all the channels to the same level
+   * 
+   * @param level The target perceptual level (0-255)
+   * @param ms The fade duration (ms)
+   * @param now The current time (ms)
+   */
+  void setAll(int level, unsigned long ms, unsigned long now);
+
+  /**
+   * Calculate the channels level and update the lights
+   * 
+   * @param out The hardware outputs
+   * @param now The current time (ms)
+   */
+  void update(Outputs &out, unsigned long now);
+
+  /**
+   * Get the current level of a channel
+   * 
+   * @param j The light channel
+   */
+  int getChannel(int j);
+
+  /**
+   * Return true if some channel is fading
+   */
+  boolean isRunning();
+};
+
+#endif
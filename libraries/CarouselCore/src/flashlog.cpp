@@ -0,0 +1,246 @@
+/**
+ * \file flashlog.cpp
+ * \brief Wear leveled log of records in the program flash
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "flashlog.h"
+
+// ========================================== Flash region
+
+#ifdef ARDUINO_ARCH_SAMD
+
+//! The log region: the last rows of the program flash, out of the program
+//! image so the uploads don't overwrite it. The content is not valid until
+//! a row is erased and written by the log
+#define FLASHLOG_ADDRESS (FLASH_ADDR + FLASH_SIZE - FLASHLOG_SIZE)
+static volatile uint8_t* const flashArea = (volatile uint8_t*)FLASHLOG_ADDRESS;
+
+//! Linker symbols: end of the code and initialized data copied to the RAM.
+//! The data initial values follow the code in the flash
+extern uint32_t __etext;
+extern uint32_t __data_start__;
+extern uint32_t __data_end__;
+
+//! Wait for the NVM controller to complete the command
+static void nvmWait() {
+  while(NVMCTRL->INTFLAG.bit.READY == 0) { }
+}
+
+//! Execute a NVM controller command on an address
+static void nvmCommand(const volatile void* address, uint32_t command) {
+  // The address register is in 16 bit words
+  NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;
+  NVMCTRL->ADDR.reg = ((uint32_t)address) / 2;
+  NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | command;
+  nvmWait();
+}
+
+boolean FlashRegion::begin() {
+  uint32_t imageEnd = (uint32_t)&__etext +
+                      ((uint32_t)&__data_end__ - (uint32_t)&__data_start__);
+
+  // A program growing into the region would be corrupted by the log
+  return imageEnd <= FLASHLOG_ADDRESS;
+}
+
+void FlashRegion::read(int offset, void* buffer, int length) {
+  memcpy(buffer, (const void*)&flashArea[offset], length);
+}
+
+void FlashRegion::writePage(int offset, const void* buffer) {
+  volatile uint32_t* dst = (volatile uint32_t*)&flashArea[offset];
+  const uint8_t* src = (const uint8_t*)buffer;
+  uint32_t word;
+  int j;
+
+  // Manual write: the page is written by the write page command
+  NVMCTRL->CTRLB.bit.MANW = 1;
+  nvmCommand(dst, NVMCTRL_CTRLA_CMD_PBC);
+  // The page buffer accepts 32 bit writes only
+  for(j = 0; j < FLASHLOG_PAGE_SIZE; j += 4) {
+    memcpy(&word, &src[j], 4);
+    dst[j / 4] = word;
+  }
+  nvmCommand(dst, NVMCTRL_CTRLA_CMD_WP);
+}
+
+void FlashRegion::eraseRow(int offset) {
+  nvmCommand(&flashArea[offset], NVMCTRL_CTRLA_CMD_ER);
+}
+
+#else
+
+//! Flash simulated in RAM. Starts erased, as a new board
+static uint8_t flashArea[FLASHLOG_SIZE];
+//! The simulated flash has been initialized
+static boolean flashReady = false;
+
+//! Erase the simulated flash on the first access
+static void flashInit() {
+  if(flashReady == false) {
+    memset(flashArea, 0xFF, FLASHLOG_SIZE);
+    flashReady = true;
+  }
+}
+
+boolean FlashRegion::begin() {
+  flashInit();
+  return true;
+}
+
+void FlashRegion::read(int offset, void* buffer, int length) {
+  flashInit();
+  memcpy(buffer, &flashArea[offset], length);
+}
+
+void FlashRegion::writePage(int offset, const void* buffer) {
+  const uint8_t* src = (const uint8_t*)buffer;
+  int j;
+
+  flashInit();
+  // As the real flash, a write can only clear bits
+  for(j = 0; j < FLASHLOG_PAGE_SIZE; j++) {
+    flashArea[offset + j] &= src[j];
+  }
+}
+
+void FlashRegion::eraseRow(int offset) {
+  flashInit();
+  memset(&flashArea[offset], 0xFF, FLASHLOG_ROW_SIZE);
+}
+
+#endif
+
+// ========================================== Log
+
+uint16_t FlashLog::crc(const FlashRecord &record) {
+  const uint8_t* bytes = (const uint8_t*)&record;
+  uint16_t value = 0xFFFF;
+  int j, k;
+
+  for(j = 0; j < FLASHLOG_PAGE_SIZE; j++) {
+    // Skip the CRC itself
+    if( (j == offsetof(FlashRecord, crc)) || (j == offsetof(FlashRecord, crc) + 1) ) {
+      continue;
+    }
+    value ^= (uint16_t)bytes[j] << 8;
+    for(k = 0; k < 8; k++) {
+      if(value & 0x8000) {
+        value = (value << 1) ^ 0x1021;
+      } else {
+        value <<= 1;
+      }
+    }
+  }
+  return value;
+}
+
+boolean FlashLog::readRecord(int j, FlashRecord &record) {
+  flash.read(j * FLASHLOG_PAGE_SIZE, &record, FLASHLOG_PAGE_SIZE);
+  return (record.seq != 0xFFFFFFFFUL) && (record.length <= FLASHLOG_DATA_SIZE) &&
+         (record.crc == crc(record));
+}
+
+boolean FlashLog::isBlank(int j) {
+  FlashRecord record;
+  const uint8_t* bytes = (const uint8_t*)&record;
+  int k;
+
+  flash.read(j * FLASHLOG_PAGE_SIZE, &record, FLASHLOG_PAGE_SIZE);
+  for(k = 0; k < FLASHLOG_PAGE_SIZE; k++) {
+    if(bytes[k] != 0xFF) {
+      return false;
+    }
+  }
+  return true;
+}
+
+boolean FlashLog::begin() {
+  FlashRecord record;
+  int row = -1;
+  int j;
+
+  last = -1;
+  seq = 0;
+  available = flash.begin();
+  if(!available) {
+    return false;
+  }
+
+  // Find the row starting with the most recent record
+  for(j = 0; j < FLASHLOG_ROWS; j++) {
+    if(readRecord(j * FLASHLOG_ROW_PAGES, record) && ((row < 0) || (record.seq > seq)) ) {
+      row = j;
+      seq = record.seq;
+    }
+  }
+  if(row < 0) {
+    // Empty log
+    return false;
+  }
+
+  // Scan the row for the most recent record. The invalid pages
+  // (interrupted writes) are skipped
+  last = row * FLASHLOG_ROW_PAGES;
+  for(j = last + 1; j < (row + 1) * FLASHLOG_ROW_PAGES; j++) {
+    if(readRecord(j, record) && (record.seq > seq) ) {
+      last = j;
+      seq = record.seq;
+    }
+  }
+  return true;
+}
+
+boolean FlashLog::read(void* data, int length) {
+  FlashRecord record;
+
+  if( (last < 0) || !readRecord(last, record) || (record.length != length) ) {
+    return false;
+  }
+  memcpy(data, record.data, length);
+  return true;
+}
+
+boolean FlashLog::append(const void* data, int length) {
+  FlashRecord record;
+  int j;
+
+  if( (!available) || (length < 0) || (length > FLASHLOG_DATA_SIZE) ) {
+    return false;
+  }
+
+  // Next free page. The pages not erased (e.g. a write interrupted
+  // by a power loss) are skipped until the start of the next row
+  j = (last + 1) % FLASHLOG_RECORDS;
+  while( ((j % FLASHLOG_ROW_PAGES) != 0) && !isBlank(j) ) {
+    j = (j + 1) % FLASHLOG_RECORDS;
+  }
+  // Entering a new row, erase it. This is the only erase
+  // and the rows are used in turn
+  if( (j % FLASHLOG_ROW_PAGES) == 0) {
+    flash.eraseRow(j * FLASHLOG_PAGE_SIZE);
+  }
+
+  memset(&record, 0xFF, sizeof(record));
+  record.seq = seq + 1;
+  record.length = length;
+  memcpy(record.data, data, length);
+  record.crc = crc(record);
+  flash.writePage(j * FLASHLOG_PAGE_SIZE, &record);
+
+  // Verify the write
+  if(!readRecord(j, record)) {
+    return false;
+  }
+  last = j;
+  seq = record.seq;
+  return true;
+}
+
+unsigned long FlashLog::getSequence() {
+  return seq;
+}
@@ -0,0 +1,157 @@
+/**
+ * \file flashlog.h
+ * \brief Wear leveled log of records in the program flash
+ * 
+ * The log keeps the last version of a small block of data (e.g. the lifetime
+ * counters of the IoT status) across the power cycles. Every save appends a
+ * new record, one flash page each, so the writes are spread over all the
+ * FLASHLOG_ROWS rows of the region and a row is erased only when the log
+ * wraps around to it.
+ * 
+ * Every record has an increasing sequence number and a CRC. On boot only the
+ * first record of every row is read to find the most recent row, then that
+ * row is scanned to find the last valid record. A record partially written
+ * during a power loss fails the CRC and the previous one is used.
+ * 
+ * \note On the SAMD21 the region is the last FLASHLOG_SIZE bytes of the
+ * program flash, written through the NVM controller. It is out of the
+ * program image, so uploading a sketch doesn't overwrite it (an upload tool
+ * erasing the whole flash still clears it), and the log is disabled if the
+ * program grows into it. On the other architectures the flash is simulated
+ * in RAM, with the same erase and write behavior, so the log can run outside
+ * of the board.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _FLASHLOG
+#define _FLASHLOG
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Size (bytes) of the log region
+#define FLASHLOG_SIZE (FLASHLOG_ROWS * FLASHLOG_ROW_SIZE)
+//! Number of records (pages) in a row
+#define FLASHLOG_ROW_PAGES (FLASHLOG_ROW_SIZE / FLASHLOG_PAGE_SIZE)
+//! Total number of records in the log region
+#define FLASHLOG_RECORDS (FLASHLOG_ROWS * FLASHLOG_ROW_PAGES)
+//! Max size (bytes) of the data saved in a record
+#define FLASHLOG_DATA_SIZE (FLASHLOG_PAGE_SIZE - 8)
+
+//! A log record, the size of a flash page
+typedef struct {
+  uint32_t seq;                     ///< Sequence number, 0xFFFFFFFF in an erased page
+  uint16_t length;                  ///< Length of the data
+  uint16_t crc;                     ///< CRC of the sequence number, length and data
+  uint8_t data[FLASHLOG_DATA_SIZE]; ///< Saved data
+} FlashRecord;
+
+//! Flash region hosting the log. Erase sets all the bytes to 0xFF,
+//! write can only clear bits
+class FlashRegion {
+  public:
+  /**
+   * Prepare the region for the log
+   * 
+   * @return false if the region can't be used
+   */
+  boolean begin();
+
+  /**
+   * Read from the region
+   * 
+   * @param offset Position in the region
+   * @param buffer The destination buffer
+   * @param length Number of bytes to read
+   */
+  void read(int offset, void* buffer, int length);
+
+  /**
+   * Write a page of the region. The page should be erased
+   * 
+   * @param offset Position of the page in the region
+   * @param buffer The page content, FLASHLOG_PAGE_SIZE bytes
+   */
+  void writePage(int offset, const void* buffer);
+
+  /**
+   * Erase a row of the region
+   * 
+   * @param offset Position of the row in the region
+   */
+  void eraseRow(int offset);
+};
+
+//! Append only log of data records with wear leveling
+class FlashLog {
+  private:
+  //! Flash region of the log
+  FlashRegion flash;
+  //! Index of the last valid record, -1 if the log is empty
+  int last;
+  //! Sequence number of the last valid record
+  uint32_t seq;
+  //! False if the flash region can't be used
+  boolean available;
+
+  /**
+   * Read a record and check it
+   * 
+   * @param j The record index
+   * @param record The record read
+   * @return true if the record is valid
+   */
+  boolean readRecord(int j, FlashRecord &record);
+
+  /**
+   * Return true if the record page is erased
+   * 
+   * @param j The record index
+   */
+  boolean isBlank(int j);
+
+  /**
+   * Calculate the CRC (CCITT) of a record
+   */
+  uint16_t crc(const FlashRecord &record);
+
+  public:
+  /**
+   * Find the last valid record in the flash. Only the first record of
+   * the rows and the records of the most recent row are read
+   * 
+   * @return true if a valid record has been found, false if the log is
+   * empty or the flash region can't be used
+   */
+  boolean begin();
+
+  /**
+   * Read the data of the last valid record
+   * 
+   * @param data The destination buffer
+   * @param length The size of the data
+   * @return false if the log is empty or the saved data has a different size
+   */
+  boolean read(void* data, int length);
+
+  /**
+   * Save a new version of the data
+   * 
+   * @param data The data to save
+   * @param length The size of the data, up to FLASHLOG_DATA_SIZE
+   * @return false if the data is too long, the record can't be verified or
+   * the flash region can't be used
+   */
+  boolean append(const void* data, int length);
+
+  /**
+   * Get the sequence number of the last saved record, e.g. to know
+   * how many times the data has been saved
+   */
+  unsigned long getSequence();
+};
+
+#endif
@@ -0,0 +1,232 @@
+/**
+ * \file globals.h
+ * \brief constants and profile defaults for the RataingBalls + Lights and Music
+ * 
+ * \date May 2019
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * 
+ */
+
+#ifndef _GLOBALS
+#define _GLOBALS
+
+// ========================================== Hardware settings
+
+#define LIGHTSERVO_1_PIN 0    //! Light servo
+#define LIGHTSERVO_2_PIN 1    //! Light servo
+#define LIGHTSERVO_3_PIN 2    //! Light servo
+#define LIGHTSERVO_4_PIN 8    //! Light servo
+#define WHEEL_SERVO_PIN 3     //! Continuous servo rotating wheel
+
+#define LIGHT_1_PIN 4    //! Light PWM control
+#define LIGHT_2_PIN 5    //! Light PWM control
+#define LIGHT_3_PIN 6    //! Light PWM control
+#define LIGHT_4_PIN 7    //! Light PWM control
+
+#define NUMSERVOS 5          //! Total number of servos to manage them in an array
+#define NUMLIGHTS 4         //! Total number of lights
+#define NUMPINS 22          //! Total number of digital pins (including the analog pins)
+
+#define MUSIC_TRIGGER_PIN 10   ///< Start the music until the signal is low
+#define PIR_PIN 9       //! PIR sensor input
+
+// ========================================== Sound board serial link
+
+#define SOUND_LINK_SPEED 57600      ///< Link speed, a frame takes less than a 9600 baud byte
+#define SOUND_LINK_START 0xA5       ///< Frame start byte
+#define SOUND_LINK_FRAME_LEN 5      ///< Frame length
+#define SOUND_LINK_POLL 500UL       ///< Interval (ms) of the status requests
+#define SOUND_LINK_TIMEOUT 1500UL   ///< Time (ms) without frames the link is considered broken
+#define SOUND_FADE_OUT 3000         ///< Music fade out duration (ms) when the music stops
+
+#define SOUND_CMD_PLAY 0x01         ///< Play the track in the parameter
+#define SOUND_CMD_NEXT 0x02         ///< Play the next track
+#define SOUND_CMD_VOLUME 0x03       ///< Set the max volume, 0 to use the sound board trimmer
+#define SOUND_CMD_FADE 0x04         ///< Fade out in the parameter time (ms) and stop
+#define SOUND_CMD_STOP 0x05         ///< Stop immediately
+#define SOUND_CMD_STATUS 0x06       ///< Request the player status
+#define SOUND_EVT_STATUS 0x81       ///< Player status, the track playing or 0
+#define SOUND_EVT_ENDED 0x82        ///< The track in the parameter is finished
+
+// ========================================== Outputs
+
+#define OUTPUT_SERVO 0      ///< Servo outputs ID
+#define OUTPUT_LIGHT 1      ///< PWM light outputs ID
+#define OUTPUT_DIGITAL 2    ///< Digital outputs ID
+#define NUMOUTPUTKINDS 3    ///< Total number of kinds of output
+#define OUTPUT_UNKNOWN -1   ///< Shadow value of an output never written
+
+// ========================================== Default values
+
+#define LIGHT1 0    ///< Servo index in the pin array
+#define LIGHT2 1    ///< Servo index in the pin array
+#define LIGHT3 2    ///< Servo index in the pin array
+#define LIGHT4 3    ///< Servo index in the pin array
+#define WHEEL 4     ///< Servo index in the pin array
+
+#define CLOCKWISE 1         ///< Clockwise roation increment
+#define COUNTERCLOCKWISE -1 ///< Counterclockwise roation increment
+#define WHEEL_CAROUSEL 110 ///< Wheel rotating servo speed
+#define WHEEL_STOP 90       ///< Wheel ratating servo stopped
+#define WHEEL_ACCEL_TIME 1500   ///< Time (ms) to ramp the wheel from stopped to WHEEL_CAROUSEL speed
+#define WHEEL_DECEL_TIME 1000   ///< Time (ms) to ramp the wheel from WHEEL_CAROUSEL speed to stopped
+#define WHEEL_RAMP_CURVE RAMP_SMOOTH ///< Curve of the wheel speed ramps
+#define MIN_ANGLE 10        ///< Minimum servo angle
+#define MAX_ANGLE 90       ///< Maximum servo angle
+#define LOW_LIGHT 62       ///< Light level when the system is in standby (perceptual, see gamma.h)
+#define HIGH_LIGHT 234     ///< Light level when the system has been activated (perceptual, see gamma.h)
+#define LIGHT_FADE_TIME 800 ///< Duration (ms) of the lights fade between two levels
+#define PIR_ENABLED 1       ///< PIR sensor pin when a presence is detected
+#define PIR_DISABLED 0      ///< PIR sensor pint when no presence is detected
+#define PIR_DEBOUNCE 50     ///< Time (ms) a PIR level should be stable to be accepted
+#define PIR_QUEUE_SIZE 8    ///< PIR edges waiting to be processed (power of 2)
+#define CAROUSEL_CYCLE 40   ///< motion, lights and music duration (sec) ENABLED BY PIR
+#define PRESENCE_HOLD 20000UL       ///< Time (ms) the cycle continues after the last motion seen
+#define PRESENCE_MIN_CYCLE 20000UL  ///< Min duration (ms) of a cycle started by the PIR
+#define PRESENCE_MAX_CYCLE (3 * CAROUSEL_CYCLE * 1000UL) ///< Max duration (ms) of a cycle extended by the motion
+#define PRESENCE_COOLDOWN 10000UL   ///< Time (ms) the detections are ignored after a cycle
+#define SERVO_CYCLE 25      ///< Light servo rotation delaty every 1 angle step
+
+// ========================================== Idle power management
+
+#define IDLE_DETACH_DELAY 2000UL    ///< Time (ms) idle before the servos are detached
+#define IDLE_MAX_SLEEP 50UL         ///< Max sleep (ms), the latency of the remote commands when idle
+
+// ========================================== Ramps
+
+#define RAMP_LINEAR 0       ///< Constant speed ramp
+#define RAMP_SMOOTH 1       ///< Ramp starting and ending slowly
+#define RAMP_ONE 1024L      ///< Fixed point unit of the ramp position
+
+// ========================================== Light servos sweep
+
+#define SWEEP_LINEAR 0      ///< Linear sweep profile ID
+#define SWEEP_SINE 1        ///< Sine sweep profile ID
+#define SWEEP_DWELL 2       ///< Linear sweep with pause at the limits profile ID
+#define NUMSWEEPS 3         ///< Total number of sweep profiles
+#define SWEEP_PROFILE SWEEP_LINEAR  ///< Sweep profile used on startup
+#define SWEEP_STEPS (2 * (MAX_ANGLE - MIN_ANGLE))  ///< Steps of a complete back and forth sweep
+#define SWEEP_DWELL_STEPS 16    ///< Steps paused at the limits by the dwell profile
+#define NUMSERVOGROUPS 2    ///< Number of light servo groups moving together
+#define MAX_GROUP_SERVOS 2  ///< Max number of servos in a group
+
+// ========================================== IoT constants
+
+#define MQTT_BROKER_PORT 8883 ///< Remote port to connect to the broker via MQTT protocol (standard)
+#define WIFI_CONNECT_TIMEOUT 4000UL ///< Max time (ms) the WiFi module can take to join the network
+#define MQTT_CONNECT_TIMEOUT 2000UL ///< Max time (ms) a broker connection attempt (TLS handshake included) can block
+#define CONN_BACKOFF_MIN 2000UL     ///< Delay (ms) after the first failed connection attempt
+#define CONN_BACKOFF_MAX 60000UL    ///< Max delay (ms) between two connection attempts
+
+#define CONN_WIFI 0                 ///< Starting the WiFi connection
+#define CONN_WIFI_JOIN 1            ///< Waiting for the WiFi module to join the network
+#define CONN_MQTT 2                 ///< Connecting to the MQTT broker
+#define CONN_CONNECTED 3            ///< WiFi and MQTT broker connected
+#define WHEEL_RPM 8.5         ///< Rotations per minute of the wheel
+#define SPHERES_PER_ROTATION 3 ///< Number of spheres passed every rotation
+
+#define MQTT_LIGTHS "mqtt_lights"   ///< Command to start lights
+#define MQTT_MUSIC "mqtt_music"     ///< Command to start music
+#define MQTT_RUN "mqtt_run"         ///< Command to run the carousel (short time)
+#define MQTT_SWEEP_LINEAR "mqtt_sweep_linear" ///< Select the linear light servos sweep
+#define MQTT_SWEEP_SINE "mqtt_sweep_sine"     ///< Select the sine light servos sweep
+#define MQTT_SWEEP_DWELL "mqtt_sweep_dwell"   ///< Select the light servos sweep with pauses
+#define MQTT_SHOW_WAVE "mqtt_show_wave"       ///< Play the wave show
+#define MQTT_SHOW_PULSE "mqtt_show_pulse"     ///< Play the pulse show
+#define MQTT_SHOW_USER "mqtt_show_user"       ///< Play the show received from remote
+
+#define MQTT_MUSIC_TIMEOUT 5                ///< Duration of a piece of music (command mqtt_music)
+#define MQTT_MUSIC_PLAY_SONGS 5             ///< Number of songs played by mqtt music command
+#define MQTT_LIGHTS_TIMEOUT 10              ///< Duration of the command mqtt_lights
+
+#define MQTTCMD_LIGTHS 0X01        ///< Start lights ID
+#define MQTTCMD_MUSIC 0X02         ///< Start music ID
+#define MQTTCMD_RUN 0X03           ///< Run the carousel short time ID
+#define MQTTCMD_SWEEP 0X04         ///< Select the light servos sweep profile ID
+#define MQTTCMD_SHOW 0X05          ///< Play a show ID
+
+#define CMD_FRAME_MAGIC 0xCA       ///< First byte of the binary command frames
+#define CMD_FRAME_LEN 7            ///< Length of the binary command frames
+#define CMD_PRIORITY_DEFAULT 0     ///< Priority of the text commands and of the frames without priority
+
+// ========================================== Remote commands queue
+
+#define CMD_QUEUE_SIZE 8           ///< Max number of commands waiting to be executed
+#define CMD_OVERFLOW_DROP_NEW 0    ///< Queue full: drop the new command
+#define CMD_OVERFLOW_DROP_OLD 1    ///< Queue full: drop the oldest command with the lowest priority
+#define CMD_QUEUE_OVERFLOW CMD_OVERFLOW_DROP_NEW ///< Queue overflow policy
+#define CMD_MESSAGE_SIZE (2 + SHOW_MAX_KEYFRAMES * SHOW_KEYFRAME_LEN) ///< Max length of a message payload (a show frame)
+
+#define MQTT_TRIGGER_DELAY 25       ///< Time (ms) the player needs to accept the trigger change
+
+// ========================================== Remote command sequence steps
+
+#define MQTT_STEP_IDLE 0            ///< No remote command sequence is running
+#define MQTT_STEP_SONG_ON 1         ///< Trigger the player to start the next song
+#define MQTT_STEP_SONG_OFF 2        ///< Release the player trigger after the song time
+#define MQTT_STEP_LIGHTS_OFF 3      ///< Power off the lights and close the sequence
+#define MQTT_STEP_SHOW 4            ///< A show is playing
+
+// ========================================== Shows
+
+#define SHOW_TRACK_WHEEL 0          ///< Show track of the wheel speed
+#define SHOW_TRACK_LIGHT 1          ///< Show track of the first light channel, one track every light
+#define SHOW_TRACK_GROUP (SHOW_TRACK_LIGHT + NUMLIGHTS) ///< Show track of the first light servos group
+#define SHOW_TRACK_MUSIC (SHOW_TRACK_GROUP + NUMSERVOGROUPS) ///< Show track of the music trigger
+#define NUMSHOWTRACKS (SHOW_TRACK_MUSIC + 1) ///< Total number of show tracks
+
+#define SHOW_WAVE 0                 ///< Wave built-in show ID
+#define SHOW_PULSE 1                ///< Pulse built-in show ID
+#define NUMSHOWS 2                  ///< Number of built-in shows
+#define SHOW_USER 0xFF              ///< ID of the show received from remote
+
+#define SHOW_FRAME_MAGIC 0xCB       ///< First byte of the show frames
+#define SHOW_KEYFRAME_LEN 6         ///< Length of a keyframe (bytes)
+#define SHOW_MAX_KEYFRAMES 64       ///< Max number of keyframes of the show received from remote
+#define SHOW_TIME_UNIT 10           ///< Keyframes time unit (ms)
+#define SHOW_KEYS_PER_TICK 4        ///< Max number of keyframes started every loop cycle
+
+// ========================================== Scheduler
+
+#define MAX_TASKS 4                 ///< Max number of tasks the scheduler can hold at the same time
+#define NO_EVENT 0xFFFFFFFFUL       ///< Delay returned when nothing is scheduled
+
+// ========================================== Transitions timeline
+
+#define TIMELINE_SIZE 32            ///< Number of transitions kept in the timeline
+
+#define TRANSITION_PIR 'P'          ///< PIR status changed
+#define TRANSITION_WHEEL 'W'        ///< Wheel speed written to the servo
+#define TRANSITION_LIGHT 'L'        ///< Light intensity written to the lights
+#define TRANSITION_SWEEP 'S'        ///< Light servos sweep restarted (profile ID)
+#define TRANSITION_MUSIC 'M'        ///< Music trigger changed
+#define TRANSITION_SOUND_END 'E'    ///< The sound board finished a track (track number)
+#define TRANSITION_MQTT 'R'         ///< Remote command started (command ID) or ended (0)
+
+// ========================================== Telemetry
+
+#define TELEMETRY_SAMPLE_INTERVAL 500UL     ///< Time (ms) between two telemetry samples
+#define TELEMETRY_PUBLISH_INTERVAL 5000UL   ///< Max time (ms) the samples wait before being published
+#define TELEMETRY_MAX_INTERVAL 60000UL      ///< Max publish interval (ms) when the publish is failing
+#define TELEMETRY_HEARTBEAT 30000UL         ///< Max time (ms) without samples when nothing changes
+#define TELEMETRY_BATCH 4                   ///< Max number of samples in a telemetry message
+#define TELEMETRY_SERVO_DELTA 10            ///< Min light servo movement (degrees) to keep a sample
+
+// ========================================== Lifetime counters log
+
+#define FLASHLOG_PAGE_SIZE 64               ///< Flash page size (bytes), the size of a log record
+#define FLASHLOG_ROW_SIZE 256               ///< Flash row size (bytes), the erase unit
+#define FLASHLOG_ROWS 8                     ///< Number of flash rows used by the log
+
+// ========================================== Loop timing instrumentation
+
+#define PHASE_POLL 0                        ///< MQTT client poll phase ID
+#define PHASE_MQTT 1                        ///< Remote commands check phase ID
+#define PHASE_PIR 2                         ///< PIR status check phase ID
+#define PHASE_HARDWARE 3                    ///< Hardware update phase ID
+#define NUMPHASES 4                         ///< Total number of phases measured
+#define PROFILE_BUCKETS 16                  ///< Number of power of 2 buckets of the histograms
+#define PROFILE_DUMP_INTERVAL 60000UL       ///< Time (ms) between two instrumentation reports
+
+#endif
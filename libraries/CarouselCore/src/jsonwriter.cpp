@@ -0,0 +1,87 @@
+/**
+ * \file jsonwriter.cpp
+ * \brief Streaming Json writer
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#include "jsonwriter.h"
+
+JsonWriter::JsonWriter(Print &stream) : out(stream) {
+  needComma = false;
+}
+
+void JsonWriter::writeKey(const char* key) {
+  if(needComma == true) {
+    out.print(',');
+  }
+  if(key != NULL) {
+    writeString(key);
+    out.print(':');
+  }
+  needComma = true;
+}
+
+void JsonWriter::writeString(const char* s) {
+  out.print('"');
+  for( ; *s != 0; s++) {
+    if( (*s == '"') || (*s == '\\') ) {
+      out.print('\\');
+    }
+    out.print(*s);
+  }
+  out.print('"');
+}
+
+void JsonWriter::beginObject(const char* key) {
+  writeKey(key);
+  out.print('{');
+  needComma = false;
+}
+
+void JsonWriter::endObject() {
+  out.print('}');
+  needComma = true;
+}
+
+void JsonWriter::beginArray(const char* key) {
+  writeKey(key);
+  out.print('[');
+  needComma = false;
+}
+
+void JsonWriter::endArray() {
+  out.print(']');
+  needComma = true;
+}
+
+void JsonWriter::add(const char* key, long value) {
+  writeKey(key);
+  out.print(value);
+}
+
+void JsonWriter::add(const char* key, int value) {
+  add(key, long(value));
+}
+
+void JsonWriter::add(const char* key, unsigned long value) {
+  writeKey(key);
+  out.print(value);
+}
+
+void JsonWriter::add(const char* key, float value, int decimals) {
+  writeKey(key);
+  out.print(value, decimals);
+}
+
+void JsonWriter::add(const char* key, boolean value) {
+  writeKey(key);
+  out.print(value ? "true" : "false");
+}
+
+void JsonWriter::add(const char* key, const char* value) {
+  writeKey(key);
+  writeString(value);
+}
@@ -0,0 +1,81 @@
+/**
+ * \file jsonwriter.h
+ * \brief Streaming Json writer
+ * 
+ * The Json text is written directly to a Print stream (e.g. the MQTT client
+ * message) while it is generated: there are no String objects nor heap
+ * allocations. The writer only keeps track of the separators between the
+ * values, the caller is responsible to close the objects and arrays opened.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _JSONWRITER
+#define _JSONWRITER
+
+#include "Arduino.h"
+
+//! Json writer on a Print stream
+class JsonWriter {
+  private:
+  //! Output stream
+  Print &out;
+  //! True if a separator is needed before the next value
+  boolean needComma;
+
+  /**
+   * Write the separator, if needed, and the key followed by a colon
+   * 
+   * @param key The key, or NULL for the array values
+   */
+  void writeKey(const char* key);
+
+  /**
+   * Write a quoted and escaped string
+   */
+  void writeString(const char* s);
+
+  public:
+  /**
+   * @param stream The output stream
+   */
+  JsonWriter(Print &stream);
+
+  /**
+   * Open an object
+   * 
+   * @param key The object key, NULL for the root object and array elements
+   */
+  void beginObject(const char* key = NULL);
+
+  /**
+   * Close the last object opened
+   */
+  void endObject();
+
+  /**
+   * Open an array
+   * 
+   * @param key The array key, NULL for the root array and array elements
+   */
+  void beginArray(const char* key = NULL);
+
+  /**
+   * Close the last array opened
+   */
+  void endArray();
+
+  /**
+   * Write a key and value pair. The key is NULL for the array elements
+   */
+  void add(const char* key, long value);
+  void add(const char* key, int value);
+  void add(const char* key, unsigned long value);
+  void add(const char* key, float value, int decimals = 2);
+  void add(const char* key, boolean value);
+  void add(const char* key, const char* value);
+};
+
+#endif
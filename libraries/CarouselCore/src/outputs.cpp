@@ -0,0 +1,97 @@
+/**
+ * \file outputs.cpp
+ * \brief Hardware outputs with shadow values
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "outputs.h"
+
+void Outputs::begin() {
+  int j;
+
+  // Invalidate all the shadow values
+  for(j = 0; j < NUMSERVOS; j++) {
+    servoValue[j] = OUTPUT_UNKNOWN;
+  }
+  for(j = 0; j < NUMLIGHTS; j++) {
+    lightValue[j] = OUTPUT_UNKNOWN;
+  }
+  for(j = 0; j < NUMPINS; j++) {
+    digitalValue[j] = OUTPUT_UNKNOWN;
+  }
+  resetStats();
+
+  for(j = 0; j < NUMLIGHTS; j++) {
+    pinMode(lightPin[j], OUTPUT);
+  }
+
+  // Attach the servos to the corresponding pins
+  for(j = 0; j < NUMSERVOS; j++) {
+      servos[j].attach(servoPin[j]);
+  }
+}
+
+boolean Outputs::isChanged(int &shadow, int value, int kind) {
+  if(shadow == value) {
+    stats[kind].suppressed++;
+    return false;
+  }
+  shadow = value;
+  stats[kind].issued++;
+  return true;
+}
+
+void Outputs::writeServo(int j, int value) {
+  if(isChanged(servoValue[j], value, OUTPUT_SERVO)) {
+    if(!servos[j].attached()) {
+      servos[j].attach(servoPin[j]);
+    }
+    servos[j].write(value);
+  }
+}
+
+void Outputs::detachServos() {
+  int j;
+  for(j = 0; j < NUMSERVOS; j++) {
+    if(servos[j].attached()) {
+      servos[j].detach();
+    }
+  }
+}
+
+boolean Outputs::isServoAttached() {
+  int j;
+  for(j = 0; j < NUMSERVOS; j++) {
+    if(servos[j].attached()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Outputs::writeLight(int j, int value) {
+  if(isChanged(lightValue[j], value, OUTPUT_LIGHT)) {
+    analogWrite(lightPin[j], value);
+  }
+}
+
+void Outputs::writeDigital(int pin, int value) {
+  if(isChanged(digitalValue[pin], value, OUTPUT_DIGITAL)) {
+    digitalWrite(pin, value);
+  }
+}
+
+OutputStats Outputs::getStats(int kind) {
+  return stats[kind];
+}
+
+void Outputs::resetStats() {
+  int j;
+  for(j = 0; j < NUMOUTPUTKINDS; j++) {
+    stats[j].issued = 0;
+    stats[j].suppressed = 0;
+  }
+}
@@ -0,0 +1,122 @@
+/**
+ * \file outputs.h
+ * \brief Hardware outputs with shadow values
+ * 
+ * All the writes to the servos, the PWM lights and the digital outputs pass
+ * through this class. The last value written to every output is kept in memory
+ * and the hardware is accessed only when the new value is different. Rewriting
+ * the same servo position is not only a waste of time but it is also a source
+ * of jitter for the light servos.
+ * 
+ * The number of writes issued to the hardware and the number of writes
+ * suppressed because redundant are counted for every kind of output.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _OUTPUTS
+#define _OUTPUTS
+
+#include "Arduino.h"
+#include <Servo.h>
+#include "globals.h"
+
+//! Write counters of a kind of output
+typedef struct {
+  unsigned long issued;      ///< Writes sent to the hardware
+  unsigned long suppressed;  ///< Writes skipped because the value didn't change
+} OutputStats;
+
+//! Shadowed hardware outputs
+class Outputs {
+  private:
+  //! Array of the servo pins
+  //! Note that the first four indexes are normal servos while the fifth is a rotating servo
+  int servoPin[NUMSERVOS] = { LIGHTSERVO_1_PIN, LIGHTSERVO_2_PIN, LIGHTSERVO_3_PIN, LIGHTSERVO_4_PIN, WHEEL_SERVO_PIN };
+
+  //! Array of the light pins
+  //! Light intensity is controlled through PWM so the pins are selected accordingly
+  int lightPin[NUMLIGHTS] = { LIGHT_1_PIN, LIGHT_2_PIN, LIGHT_3_PIN, LIGHT_4_PIN };
+
+  //! Array of the servo library instances (one every servo)
+  Servo servos[NUMSERVOS];
+
+  //! Last value written to the servos
+  int servoValue[NUMSERVOS];
+  //! Last value written to the lights
+  int lightValue[NUMLIGHTS];
+  //! Last value written to the digital pins, by pin number
+  int digitalValue[NUMPINS];
+
+  //! Write counters, by kind of output
+  OutputStats stats[NUMOUTPUTKINDS];
+
+  /**
+   * Update the counters and return true if the value should be written
+   * 
+   * @param shadow The last value written to the output
+   * @param value The new value
+   * @param kind The kind of output
+   */
+  boolean isChanged(int &shadow, int value, int kind);
+
+  public:
+  /**
+   * Initialize the output pins and attach the servos. The shadow values are
+   * invalidated so the first write to every output always reaches the hardware
+   */
+  void begin();
+
+  /**
+   * Set a servo position (or speed for the rotating servo). A detached
+   * servo is attached again
+   * 
+   * @param j The servo index
+   * @param value The servo angle
+   */
+  void writeServo(int j, int value);
+
+  /**
+   * Detach all the servos. The servos are not powered anymore and keep
+   * their position by friction. A servo is attached again by the
+   * next writeServo() changing its value
+   */
+  void detachServos();
+
+  /**
+   * Return true if at least one servo is attached
+   */
+  boolean isServoAttached();
+
+  /**
+   * Set a light intensity
+   * 
+   * @param j The light index
+   * @param value The PWM value
+   */
+  void writeLight(int j, int value);
+
+  /**
+   * Set a digital output. The pin should be set as output before
+   * 
+   * @param pin The pin number
+   * @param value HIGH or LOW
+   */
+  void writeDigital(int pin, int value);
+
+  /**
+   * Get the write counters of a kind of output
+   * 
+   * @param kind OUTPUT_SERVO, OUTPUT_LIGHT or OUTPUT_DIGITAL
+   */
+  OutputStats getStats(int kind);
+
+  /**
+   * Reset all the write counters
+   */
+  void resetStats();
+};
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * \file pirqueue.cpp
+ * \brief Lock-free queue of the PIR sensor edges
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "pirqueue.h"
+
+PirQueue::PirQueue() {
+  head = 0;
+  tail = 0;
+  overflow = false;
+}
+
+boolean PirQueue::push(unsigned long t, boolean level) {
+  unsigned int h = head;
+
+  if( (h - tail) >= PIR_QUEUE_SIZE) {
+    // Queue full
+    overflow = true;
+    return false;
+  }
+  times[h & (PIR_QUEUE_SIZE - 1)] = t;
+  levels[h & (PIR_QUEUE_SIZE - 1)] = level;
+  // Publish the edge only after it has been written
+  head = h + 1;
+  return true;
+}
+
+boolean PirQueue::pop(PirEdge &edge) {
+  unsigned int t = tail;
+
+  if(t == head) {
+    // Queue empty
+    return false;
+  }
+  edge.time = times[t & (PIR_QUEUE_SIZE - 1)];
+  edge.level = levels[t & (PIR_QUEUE_SIZE - 1)];
+  // Release the slot only after it has been read
+  tail = t + 1;
+  return true;
+}
+
+boolean PirQueue::isEmpty() {
+  return tail == head;
+}
+
+boolean PirQueue::checkOverflow() {
+  if(overflow == true) {
+    overflow = false;
+    return true;
+  }
+  return false;
+}
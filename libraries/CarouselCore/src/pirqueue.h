@@ -0,0 +1,77 @@
+/**
+ * \file pirqueue.h
+ * \brief Lock-free queue of the PIR sensor edges
+ * 
+ * The PIR interrupt routine pushes the timestamped level changes and the state
+ * machine pops them in the main loop. There is only one producer (the interrupt)
+ * and one consumer (the loop), so the queue needs no locks: the producer only
+ * writes the head index and the consumer only writes the tail index.
+ * 
+ * \note The queue size must be a power of 2
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _PIRQUEUE
+#define _PIRQUEUE
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! A PIR level change
+typedef struct {
+  unsigned long time;   ///< Time (ms) of the change
+  boolean level;        ///< PIR level after the change
+} PirEdge;
+
+//! Single producer, single consumer queue of PIR edges
+class PirQueue {
+  private:
+  //! Edges times (ms)
+  volatile unsigned long times[PIR_QUEUE_SIZE];
+  //! Edges levels
+  volatile boolean levels[PIR_QUEUE_SIZE];
+  //! Next position to write, changed by the producer only
+  volatile unsigned int head;
+  //! Next position to read, changed by the consumer only
+  volatile unsigned int tail;
+  //! Set by the producer when an edge is lost, reset by the consumer
+  volatile boolean overflow;
+
+  public:
+  PirQueue();
+
+  /**
+   * Add an edge to the queue. Called by the interrupt routine
+   * 
+   * @param t The time of the change (ms)
+   * @param level The new PIR level
+   * @return false if the queue is full and the edge has been lost
+   */
+  boolean push(unsigned long t, boolean level);
+
+  /**
+   * Get the oldest edge from the queue. Called by the main loop
+   * 
+   * @param edge Filled with the edge, if any
+   * @return false if the queue is empty
+   */
+  boolean pop(PirEdge &edge);
+
+  /**
+   * Return true if there are no edges waiting. Can be called
+   * while waiting for the interrupt
+   */
+  boolean isEmpty();
+
+  /**
+   * Return true, and reset the flag, if some edges have been lost
+   * since the last call. In this case the consumer should read the
+   * sensor level again.
+   */
+  boolean checkOverflow();
+};
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * \file power.h
+ * \brief Idle power management statistics and sleep
+ * 
+ * When the carousel is idle (no cycle, no ramps, no remote commands) the state
+ * machine detaches the servos after IDLE_DETACH_DELAY ms and the processor
+ * sleeps between the loop cycles. The sleep ends at the first interrupt
+ * that queues a PIR edge, or after IDLE_MAX_SLEEP ms so the network client
+ * can read the commands and send the keep alives.
+ * 
+ * The worst wake latency is then one interrupt period (the 1 ms SysTick) for
+ * a detection and IDLE_MAX_SLEEP for a remote command.
+ * 
+ * \note The processor sleeps with the wait for interrupt instruction on the
+ * SAMD21 (idle mode, the peripherals and the timers keep running). On the other
+ * architectures the sleep is only a wait, with the same timing: the core gets
+ * the control with yield() (the host simulator moves its virtual clock there).
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _POWER
+#define _POWER
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Idle and sleep statistics
+typedef struct {
+  unsigned long timerStart;     ///< Time (ms) the statistics started
+  unsigned long sleepTime;      ///< Total time (ms) spent sleeping
+  unsigned long sleeps;         ///< Number of sleeps
+  unsigned long wakeups;        ///< Sleeps ended by a PIR edge
+  unsigned long maxWakeLatency; ///< Max time (ms) from a PIR edge to its processing
+  unsigned long detaches;       ///< Number of times the servos have been detached
+} PowerStats;
+
+//! Wait for the next interrupt, sleeping if the architecture supports it
+inline void waitForInterrupt() {
+#ifdef ARDUINO_ARCH_SAMD
+  __WFI();
+#else
+  yield();
+#endif
+}
+
+/**
+ * Get the time (ms) the machine has been active, not sleeping
+ * 
+ * @param stats The power statistics
+ * @param now The current time (ms)
+ */
+inline unsigned long getActiveTime(const PowerStats &stats, unsigned long now) {
+  return now - stats.timerStart - stats.sleepTime;
+}
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * \file presence.cpp
+ * \brief PIR presence model deciding the carousel cycle duration
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "presence.h"
+
+void Presence::begin(unsigned long now) {
+  timerStart = now;
+  timerEnd = now - PRESENCE_COOLDOWN;
+  lastMotion = now;
+}
+
+void Presence::update(boolean motion, unsigned long now) {
+  if(motion == true) {
+    lastMotion = now;
+  }
+}
+
+void Presence::cycleStart(unsigned long now) {
+  timerStart = now;
+  lastMotion = now;
+}
+
+void Presence::cycleEnd(unsigned long now) {
+  timerEnd = now;
+}
+
+unsigned long Presence::getTimeLeft(unsigned long now) {
+  // Durations from the cycle start, safe when millis() rolls over
+  unsigned long duration = lastMotion - timerStart + PRESENCE_HOLD;
+  unsigned long elapsed = now - timerStart;
+
+  if(duration < PRESENCE_MIN_CYCLE) {
+    duration = PRESENCE_MIN_CYCLE;
+  } else if(duration > PRESENCE_MAX_CYCLE) {
+    duration = PRESENCE_MAX_CYCLE;
+  }
+  if(elapsed >= duration) {
+    return 0;
+  }
+  return duration - elapsed;
+}
+
+unsigned long Presence::getCoolDown(unsigned long now) {
+  unsigned long elapsed = now - timerEnd;
+
+  if(elapsed >= PRESENCE_COOLDOWN) {
+    return 0;
+  }
+  return PRESENCE_COOLDOWN - elapsed;
+}
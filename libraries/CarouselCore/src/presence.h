@@ -0,0 +1,82 @@
+/**
+ * \file presence.h
+ * \brief PIR presence model deciding the carousel cycle duration
+ * 
+ * The PIR sensor is followed also while the carousel is running. Every time
+ * motion is seen the end of the cycle is moved PRESENCE_HOLD ms after it, so
+ * the cycle continues while people are around and ends early when the area
+ * is empty. The cycle lasts at least PRESENCE_MIN_CYCLE and at most
+ * PRESENCE_MAX_CYCLE ms.
+ * 
+ * After a cycle the detections are ignored for PRESENCE_COOLDOWN ms, so the
+ * people leaving the area don't start a new cycle.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _PRESENCE
+#define _PRESENCE
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Presence estimator
+class Presence {
+  private:
+  //! Time (ms) the current cycle started
+  unsigned long timerStart;
+  //! Time (ms) the last cycle ended
+  unsigned long timerEnd;
+  //! Time (ms) of the last motion seen
+  unsigned long lastMotion;
+
+  public:
+  /**
+   * Initialize the model. There is no cool down after the boot
+   * 
+   * @param now The current time (ms)
+   */
+  void begin(unsigned long now);
+
+  /**
+   * Update the model with the PIR level. Should be called every loop cycle
+   * 
+   * @param motion The debounced PIR level
+   * @param now The current time (ms)
+   */
+  void update(boolean motion, unsigned long now);
+
+  /**
+   * A cycle has been started by a detection
+   * 
+   * @param now The current time (ms)
+   */
+  void cycleStart(unsigned long now);
+
+  /**
+   * The cycle has been stopped, start the cool down
+   * 
+   * @param now The current time (ms)
+   */
+  void cycleEnd(unsigned long now);
+
+  /**
+   * Get the time left before the end of the running cycle
+   * 
+   * @param now The current time (ms)
+   * @return the time (ms), 0 if the cycle should end
+   */
+  unsigned long getTimeLeft(unsigned long now);
+
+  /**
+   * Get the time left before the detections are accepted again
+   * 
+   * @param now The current time (ms)
+   * @return the time (ms), 0 if the cool down is over
+   */
+  unsigned long getCoolDown(unsigned long now);
+};
+
+#endif
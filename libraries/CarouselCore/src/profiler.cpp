@@ -0,0 +1,98 @@
+/**
+ * \file profiler.cpp
+ * \brief Loop timing instrumentation
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#include "profiler.h"
+
+//! Phases names, by phase ID
+static const char* phaseNames[NUMPHASES] = { "poll", "mqtt", "pir", "hardware" };
+
+Profiler::Profiler() {
+  loopStart = 0;
+  reset();
+}
+
+void Profiler::reset() {
+  int j;
+
+  memset(&loops, 0, sizeof(TimingStats));
+  memset(&servoLateness, 0, sizeof(TimingStats));
+  for(j = 0; j < NUMPHASES; j++) {
+    memset(&phases[j], 0, sizeof(TimingStats));
+  }
+}
+
+void Profiler::addSample(TimingStats &stats, unsigned long value) {
+  int j;
+
+  if( (stats.count == 0) || (value < stats.minimum) ) {
+    stats.minimum = value;
+  }
+  if(value > stats.maximum) {
+    stats.maximum = value;
+  }
+  stats.count++;
+  stats.sum += value;
+
+  // Find the first power of 2 bucket including the value
+  for(j = 0; (j < PROFILE_BUCKETS - 1) && (value >= (1UL << j)); j++);
+  stats.histogram[j]++;
+}
+
+void Profiler::loopTick(unsigned long nowMicros) {
+  loopStart = nowMicros;
+}
+
+void Profiler::loopEnd(unsigned long nowMicros) {
+  // The loop work only: the idle sleep is in the power stats
+  addSample(loops, nowMicros - loopStart);
+}
+
+void Profiler::addPhase(int phase, unsigned long us) {
+  addSample(phases[phase], us);
+}
+
+void Profiler::addServoLateness(unsigned long ms) {
+  addSample(servoLateness, ms);
+}
+
+void Profiler::printStats(Print &out, const char* name, TimingStats &stats) {
+  int j;
+
+  out.print(name);
+  out.print(" n=");
+  out.print(stats.count);
+  if(stats.count > 0) {
+    out.print(" min=");
+    out.print(stats.minimum);
+    out.print(" max=");
+    out.print(stats.maximum);
+    out.print(" mean=");
+    out.print(stats.sum / stats.count);
+    // Only the buckets with samples
+    for(j = 0; j < PROFILE_BUCKETS; j++) {
+      if(stats.histogram[j] > 0) {
+        out.print(" <");
+        out.print(1UL << j);
+        out.print(':');
+        out.print(stats.histogram[j]);
+      }
+    }
+  }
+  out.println();
+}
+
+void Profiler::dump(Print &out) {
+  int j;
+
+  printStats(out, "loop(us)", loops);
+  for(j = 0; j < NUMPHASES; j++) {
+    printStats(out, phaseNames[j], phases[j]);
+  }
+  printStats(out, "servo late(ms)", servoLateness);
+}
@@ -0,0 +1,132 @@
+/**
+ * \file profiler.h
+ * \brief Loop timing instrumentation
+ * 
+ * Measures the duration of the main loop, the idle sleep excluded, and of
+ * its phases (MQTT poll, remote
+ * commands, PIR check, hardware update) and how late the light servos steps
+ * are executed compared with SERVO_CYCLE. For every measure the min, max and
+ * mean values are kept together with a histogram with power of 2 buckets.
+ * 
+ * The profiler class is part of the core library, the sketch owns the
+ * profiler instance. The instrumentation exists only when _PROFILE is
+ * defined in the config.h of the sketch: without it the PROFILE_xxx macros
+ * are empty and the profiler code is not linked.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _PROFILER
+#define _PROFILER
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Timing statistics of a measure
+typedef struct {
+  unsigned long count;    ///< Number of samples
+  unsigned long minimum;  ///< Shortest sample
+  unsigned long maximum;  ///< Longest sample
+  unsigned long sum;      ///< Sum of the samples, to calculate the mean
+  //! Number of samples by bucket. Bucket j counts the samples lower than 2^j
+  unsigned long histogram[PROFILE_BUCKETS];
+} TimingStats;
+
+//! Loop timing profiler
+class Profiler {
+  private:
+  //! Loop duration (us)
+  TimingStats loops;
+  //! Phases duration (us)
+  TimingStats phases[NUMPHASES];
+  //! Light servos steps delay (ms)
+  TimingStats servoLateness;
+  //! Time (us) the current loop started
+  unsigned long loopStart;
+
+  /**
+   * Add a sample to the statistics
+   */
+  void addSample(TimingStats &stats, unsigned long value);
+
+  /**
+   * Print the statistics
+   */
+  void printStats(Print &out, const char* name, TimingStats &stats);
+
+  public:
+  Profiler();
+
+  /**
+   * Reset all the statistics
+   */
+  void reset();
+
+  /**
+   * Mark the start of a loop
+   * 
+   * @param nowMicros The current time (us)
+   */
+  void loopTick(unsigned long nowMicros);
+
+  /**
+   * Mark the end of the loop work, before the idle sleep, measuring the
+   * loop duration
+   * 
+   * @param nowMicros The current time (us)
+   */
+  void loopEnd(unsigned long nowMicros);
+
+  /**
+   * Add a phase duration
+   * 
+   * @param phase The phase ID (PHASE_xxx)
+   * @param us The phase duration (us)
+   */
+  void addPhase(int phase, unsigned long us);
+
+  /**
+   * Add the delay of a light servos step
+   * 
+   * @param ms The time (ms) passed after the step was due
+   */
+  void addServoLateness(unsigned long ms);
+
+  /**
+   * Print all the statistics, e.g. to Serial or to a MQTT message
+   * 
+   * @param out The output stream
+   */
+  void dump(Print &out);
+};
+
+#ifdef _PROFILE
+
+//! The loop profiler, defined by the sketch
+extern Profiler profiler;
+
+//! Give the profiler to the state machine
+#define PROFILE_ATTACH(machine) machine.setProfiler(&profiler)
+
+//! Mark the start of a loop
+#define PROFILE_LOOP() profiler.loopTick(micros())
+//! Mark the end of the loop work, before the idle sleep
+#define PROFILE_LOOP_END() profiler.loopEnd(micros())
+//! Start measuring a phase
+#define PROFILE_BEGIN(phase) unsigned long profile_##phase = micros()
+//! End measuring a phase
+#define PROFILE_END(phase) profiler.addPhase(phase, micros() - profile_##phase)
+
+#else
+
+#define PROFILE_ATTACH(machine)
+#define PROFILE_LOOP()
+#define PROFILE_LOOP_END()
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+
+#endif
+
+#endif
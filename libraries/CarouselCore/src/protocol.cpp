@@ -0,0 +1,63 @@
+/**
+ * \file protocol.cpp
+ * \brief Remote commands protocol parser
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "protocol.h"
+
+//! Legacy text command
+typedef struct {
+  const char* payload;  ///< Command text
+  int id;               ///< Command ID
+  int level;            ///< Level parameter
+} TextCommand;
+
+//! Legacy text commands
+static const TextCommand textCommands[] = {
+  { MQTT_LIGTHS, MQTTCMD_LIGTHS, 0 },
+  { MQTT_MUSIC, MQTTCMD_MUSIC, 0 },
+  { MQTT_RUN, MQTTCMD_RUN, 0 },
+  { MQTT_SWEEP_LINEAR, MQTTCMD_SWEEP, SWEEP_LINEAR },
+  { MQTT_SWEEP_SINE, MQTTCMD_SWEEP, SWEEP_SINE },
+  { MQTT_SWEEP_DWELL, MQTTCMD_SWEEP, SWEEP_DWELL },
+  { MQTT_SHOW_WAVE, MQTTCMD_SHOW, SHOW_WAVE },
+  { MQTT_SHOW_PULSE, MQTTCMD_SHOW, SHOW_PULSE },
+  { MQTT_SHOW_USER, MQTTCMD_SHOW, SHOW_USER }
+};
+
+boolean parseCommand(const char bytes[], int length, MqttCommand &cmd) {
+  const byte* frame = (const byte*)bytes;
+  unsigned int j;
+
+  cmd.seq = 0;
+  cmd.priority = CMD_PRIORITY_DEFAULT;
+  cmd.duration = 0;
+  cmd.level = 0;
+  cmd.count = 0;
+
+  // Binary frame
+  if( (length == CMD_FRAME_LEN) && (frame[0] == CMD_FRAME_MAGIC) ) {
+    cmd.id = frame[1] & 0x0F;
+    cmd.priority = frame[1] >> 4;
+    cmd.seq = frame[2];
+    cmd.duration = (frame[3] << 8) | frame[4];
+    cmd.level = frame[5];
+    cmd.count = frame[6];
+    return (cmd.id >= MQTTCMD_LIGTHS) && (cmd.id <= MQTTCMD_SHOW);
+  }
+
+  // Text command
+  for(j = 0; j < sizeof(textCommands) / sizeof(TextCommand); j++) {
+    if( (length == int(strlen(textCommands[j].payload))) &&
+        (memcmp(bytes, textCommands[j].payload, length) == 0) ) {
+      cmd.id = textCommands[j].id;
+      cmd.level = textCommands[j].level;
+      return true;
+    }
+  }
+  return false;
+}
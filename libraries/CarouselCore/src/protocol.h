@@ -0,0 +1,42 @@
+/**
+ * \file protocol.h
+ * \brief Remote commands protocol parser
+ * 
+ * The remote commands can be sent as the legacy text payloads (e.g. "mqtt_run")
+ * or as a compact binary frame with the command parameters:
+ * 
+ * | Byte | Content                                           |
+ * |------|---------------------------------------------------|
+ * | 0    | CMD_FRAME_MAGIC                                   |
+ * | 1    | Priority (high nibble), command ID (low nibble)   |
+ * | 2    | Sequence number                                   |
+ * | 3-4  | Duration (s), most significant byte first         |
+ * | 5    | Level (light intensity or sweep profile ID)       |
+ * | 6    | Count (number of songs)                           |
+ * 
+ * The parameters set to 0 are replaced by the command defaults. The payload is
+ * parsed directly from the MQTT client receive buffer, without String objects.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _PROTOCOL
+#define _PROTOCOL
+
+#include "Arduino.h"
+#include "globals.h"
+#include "structs.h"
+
+/**
+ * Decode a remote command payload, binary or text
+ * 
+ * @param bytes The payload
+ * @param length The payload length
+ * @param cmd Filled with the command ID and parameters
+ * @return false if the payload is not a valid command
+ */
+boolean parseCommand(const char bytes[], int length, MqttCommand &cmd);
+
+#endif
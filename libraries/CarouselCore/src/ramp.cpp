@@ -0,0 +1,76 @@
+/**
+ * \file ramp.cpp
+ * \brief Time based ramp generator
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "ramp.h"
+
+Ramp::Ramp() {
+  begin(0);
+}
+
+void Ramp::begin(int v) {
+  startValue = v;
+  targetValue = v;
+  value = v;
+  timerStart = 0;
+  duration = 0;
+  curve = RAMP_LINEAR;
+  running = false;
+}
+
+void Ramp::setTarget(int target, unsigned long ms, int rampCurve, unsigned long now) {
+  if(target == targetValue) {
+    // Already going there
+    return;
+  }
+  startValue = value;
+  targetValue = target;
+  timerStart = now;
+  duration = ms;
+  curve = rampCurve;
+  running = true;
+  update(now);
+}
+
+int Ramp::update(unsigned long now) {
+  unsigned long elapsed;
+  long t;
+
+  if(running == false) {
+    return value;
+  }
+
+  elapsed = now - timerStart;
+  if(elapsed >= duration) {
+    // Target reached
+    value = targetValue;
+    running = false;
+    return value;
+  }
+
+  // Fixed point ramp position, from 0 to RAMP_ONE
+  t = long(elapsed * RAMP_ONE / duration);
+  if(curve == RAMP_SMOOTH) {
+    // Smoothstep 3t^2 - 2t^3
+    t = t * t / RAMP_ONE * (3 * RAMP_ONE - 2 * t) / RAMP_ONE;
+  }
+  value = startValue + int(long(targetValue - startValue) * t / RAMP_ONE);
+  return value;
+}
+
+int Ramp::getValue() {
+  return value;
+}
+
+int Ramp::getTarget() {
+  return targetValue;
+}
+
+boolean Ramp::isRunning() {
+  return running;
+}
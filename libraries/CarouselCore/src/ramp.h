@@ -0,0 +1,87 @@
+/**
+ * \file ramp.h
+ * \brief Time based ramp generator
+ * 
+ * The ramp moves a value from its current level to a target level in a
+ * given time. The value is calculated from the elapsed time every time
+ * update() is called, so the ramp speed does not depend on the loop
+ * frequency and nothing waits.
+ * 
+ * The ramp shape depends on the curve:
+ * - RAMP_LINEAR constant speed
+ * - RAMP_SMOOTH starts and ends slowly (smoothstep curve)
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _RAMP
+#define _RAMP
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Ramp generator
+class Ramp {
+  private:
+  //! Value when the ramp started
+  int startValue;
+  //! Value at the end of the ramp
+  int targetValue;
+  //! Last calculated value
+  int value;
+  //! Time (ms) the ramp started
+  unsigned long timerStart;
+  //! Ramp duration (ms)
+  unsigned long duration;
+  //! Ramp curve ID
+  int curve;
+  //! True until the target value is not reached
+  boolean running;
+
+  public:
+  Ramp();
+
+  /**
+   * Set the value immediately, stopping the ramp
+   * 
+   * @param v The new value
+   */
+  void begin(int v);
+
+  /**
+   * Start a new ramp from the current value
+   * 
+   * @param target The value to reach
+   * @param ms The ramp duration (ms), 0 to jump to the target
+   * @param rampCurve The curve ID (RAMP_xxx)
+   * @param now The current time (ms)
+   */
+  void setTarget(int target, unsigned long ms, int rampCurve, unsigned long now);
+
+  /**
+   * Calculate the value at the current time
+   * 
+   * @param now The current time (ms)
+   * @return the current value
+   */
+  int update(unsigned long now);
+
+  /**
+   * Get the last calculated value
+   */
+  int getValue();
+
+  /**
+   * Get the value at the end of the ramp
+   */
+  int getTarget();
+
+  /**
+   * Return true if the ramp has not reached the target value
+   */
+  boolean isRunning();
+};
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * \file scheduler.cpp
+ * \brief Cooperative millis() driven task scheduler
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "scheduler.h"
+
+Scheduler::Scheduler() {
+  int j;
+  for(j = 0; j < MAX_TASKS; j++) {
+    tasks[j].active = false;
+  }
+}
+
+int Scheduler::addTask(TaskCallback callback, void* context, unsigned long interval,
+                       unsigned long now, boolean periodic) {
+  int j;
+  for(j = 0; j < MAX_TASKS; j++) {
+    if(tasks[j].active == false) {
+      tasks[j].callback = callback;
+      tasks[j].context = context;
+      tasks[j].interval = interval;
+      tasks[j].timerStart = now;
+      tasks[j].periodic = periodic;
+      tasks[j].active = true;
+      return j;
+    }
+  }
+  // No free slots
+  return -1;
+}
+
+int Scheduler::addTimeout(TaskCallback callback, void* context, unsigned long ms, unsigned long now) {
+  return addTask(callback, context, ms, now, false);
+}
+
+int Scheduler::addPeriodic(TaskCallback callback, void* context, unsigned long ms, unsigned long now) {
+  return addTask(callback, context, ms, now, true);
+}
+
+void Scheduler::cancel(int id) {
+  if( (id >= 0) && (id < MAX_TASKS) ) {
+    tasks[id].active = false;
+  }
+}
+
+boolean Scheduler::isActive(int id) {
+  if( (id >= 0) && (id < MAX_TASKS) ) {
+    return tasks[id].active;
+  }
+  return false;
+}
+
+unsigned long Scheduler::getNextDelay(unsigned long now) {
+  int j;
+  unsigned long elapsed;
+  unsigned long next = NO_EVENT;
+
+  for(j = 0; j < MAX_TASKS; j++) {
+    if(tasks[j].active == true) {
+      elapsed = now - tasks[j].timerStart;
+      if(elapsed >= tasks[j].interval) {
+        return 0;
+      }
+      if( (tasks[j].interval - elapsed) < next) {
+        next = tasks[j].interval - elapsed;
+      }
+    } // Active task
+  } // Loop on tasks
+  return next;
+}
+
+void Scheduler::run(unsigned long now) {
+  int j;
+  for(j = 0; j < MAX_TASKS; j++) {
+    // The difference is safe also when millis() rolls over
+    if( (tasks[j].active == true) && ((now - tasks[j].timerStart) >= tasks[j].interval) ) {
+      if(tasks[j].periodic == true) {
+        // Keep the period stable, but don't try to recover
+        // more than one lost interval after a long loop
+        tasks[j].timerStart += tasks[j].interval;
+        if( (now - tasks[j].timerStart) >= tasks[j].interval) {
+          tasks[j].timerStart = now;
+        }
+      } else {
+        // Free the slot before the call, so the callback
+        // can schedule its next step
+        tasks[j].active = false;
+      }
+      tasks[j].callback(tasks[j].context);
+    } // Task is due
+  } // Loop on tasks
+}
@@ -0,0 +1,110 @@
+/**
+ * \file scheduler.h
+ * \brief Cooperative millis() driven task scheduler
+ *
+ * The scheduler holds a small fixed number of tasks. Every task is a callback
+ * that is executed when its timer expires, once (timeout tasks) or every
+ * interval (periodic tasks). Nothing blocks: run() is called every loop cycle
+ * and only executes the tasks that are due, so the loop duration does not depend
+ * on the timing of the commands in progress.
+ *
+ * \note The current time is passed by the caller instead of being read inside
+ * the scheduler, so the same code runs with a fake clock outside of the board.
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SCHEDULER
+#define _SCHEDULER
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Task function. The context is the pointer passed when the task is added
+typedef void (*TaskCallback)(void* context);
+
+//! A scheduled task
+typedef struct {
+  TaskCallback callback;    ///< Function called when the task is due
+  void* context;            ///< Parameter passed to the callback
+  unsigned long interval;   ///< Delay (ms) before the task is executed
+  unsigned long timerStart; ///< Time (ms) the interval is counted from
+  boolean periodic;         ///< If true the task is executed every interval
+  boolean active;           ///< The task slot is in use
+} Task;
+
+//! Cooperative scheduler running a fixed set of timed tasks
+class Scheduler {
+  private:
+  //! Task slots
+  Task tasks[MAX_TASKS];
+
+  /**
+   * Fill a free task slot
+   *
+   * @return the task ID or -1 if there are no free slots
+   */
+  int addTask(TaskCallback callback, void* context, unsigned long interval,
+              unsigned long now, boolean periodic);
+
+  public:
+  Scheduler();
+
+  /**
+   * Add a task executed once after the delay
+   *
+   * @param callback The function to call
+   * @param context The parameter passed to the function
+   * @param ms The delay in milliseconds
+   * @param now The current time (ms)
+   * @return the task ID or -1 if the scheduler is full
+   */
+  int addTimeout(TaskCallback callback, void* context, unsigned long ms, unsigned long now);
+
+  /**
+   * Add a task executed every interval
+   *
+   * @param callback The function to call
+   * @param context The parameter passed to the function
+   * @param ms The interval in milliseconds
+   * @param now The current time (ms)
+   * @return the task ID or -1 if the scheduler is full
+   */
+  int addPeriodic(TaskCallback callback, void* context, unsigned long ms, unsigned long now);
+
+  /**
+   * Remove a task. Invalid or already expired IDs are ignored
+   *
+   * @param id The task ID
+   */
+  void cancel(int id);
+
+  /**
+   * Return true if the task is still waiting to be executed
+   *
+   * @param id The task ID
+   */
+  boolean isActive(int id);
+
+  /**
+   * Return the time left before the first task is due. The caller can
+   * safely skip this time when nothing else happens (e.g. replaying on a
+   * virtual clock)
+   * 
+   * @param now The current time (ms)
+   * @return the delay (ms), 0 if a task is already due or NO_EVENT if there
+   * are no tasks
+   */
+  unsigned long getNextDelay(unsigned long now);
+
+  /**
+   * Execute the tasks that are due. Should be called every loop cycle
+   *
+   * @param now The current time (ms)
+   */
+  void run(unsigned long now);
+};
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * \file sequencer.cpp
+ * \brief Show player of compact keyframe timelines
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "sequencer.h"
+#include "shows.h"
+
+Sequencer::Sequencer() {
+  running = false;
+  userKeyframes = 0;
+}
+
+void Sequencer::readKeyframe(int j, Keyframe &kf) {
+  byte bytes[SHOW_KEYFRAME_LEN];
+  int k;
+
+  for(k = 0; k < SHOW_KEYFRAME_LEN; k++) {
+    if(inFlash == true) {
+      bytes[k] = pgm_read_byte(&keyframes[j * SHOW_KEYFRAME_LEN + k]);
+    } else {
+      bytes[k] = keyframes[j * SHOW_KEYFRAME_LEN + k];
+    }
+  }
+  kf.time = ((bytes[0] << 8) | bytes[1]) * SHOW_TIME_UNIT;
+  kf.track = bytes[2];
+  kf.value = bytes[3];
+  kf.duration = ((bytes[4] << 8) | bytes[5]) * SHOW_TIME_UNIT;
+}
+
+boolean Sequencer::load(const byte frame[], int length) {
+  int count;
+  int j;
+  unsigned int time;
+  unsigned int last = 0;
+
+  if( (length < 2) || (frame[0] != SHOW_FRAME_MAGIC) ) {
+    return false;
+  }
+  count = frame[1];
+  if( (count > SHOW_MAX_KEYFRAMES) || (length != 2 + count * SHOW_KEYFRAME_LEN) ) {
+    return false;
+  }
+  // Don't change the show while it is playing
+  if( (running == true) && (keyframes == userShow) ) {
+    return false;
+  }
+  // Check the keyframes
+  for(j = 0; j < count; j++) {
+    time = (frame[2 + j * SHOW_KEYFRAME_LEN] << 8) | frame[3 + j * SHOW_KEYFRAME_LEN];
+    if( (time < last) || (frame[4 + j * SHOW_KEYFRAME_LEN] >= NUMSHOWTRACKS) ) {
+      return false;
+    }
+    last = time;
+  }
+  memcpy(userShow, &frame[2], count * SHOW_KEYFRAME_LEN);
+  userKeyframes = count;
+  return true;
+}
+
+boolean Sequencer::start(int show, unsigned long now) {
+  Keyframe kf;
+  int j;
+
+  if( (show >= 0) && (show < NUMSHOWS) ) {
+    keyframes = builtinShows[show].keyframes;
+    numKeyframes = builtinShows[show].numKeyframes;
+    inFlash = true;
+  } else if(show == SHOW_USER) {
+    keyframes = userShow;
+    numKeyframes = userKeyframes;
+    inFlash = false;
+  } else {
+    return false;
+  }
+  if(numKeyframes == 0) {
+    return false;
+  }
+
+  // The show ends with the last transition. Calculated once,
+  // the ticks only read the keyframes due
+  duration = 0;
+  for(j = 0; j < numKeyframes; j++) {
+    readKeyframe(j, kf);
+    if( (kf.time + kf.duration) > duration) {
+      duration = kf.time + kf.duration;
+    }
+  }
+  cursor = 0;
+  timerStart = now;
+  running = true;
+  return true;
+}
+
+void Sequencer::stop() {
+  running = false;
+}
+
+boolean Sequencer::next(unsigned long now, Keyframe &kf) {
+  unsigned long late;
+
+  if( (running == false) || (cursor >= numKeyframes) ) {
+    return false;
+  }
+  readKeyframe(cursor, kf);
+  if( (now - timerStart) < kf.time) {
+    return false;
+  }
+  // A late keyframe ends its transition on time
+  late = now - timerStart - kf.time;
+  if(kf.duration > late) {
+    kf.duration -= late;
+  } else {
+    kf.duration = 0;
+  }
+  cursor++;
+  return true;
+}
+
+boolean Sequencer::isFinished(unsigned long now) {
+  return (cursor >= numKeyframes) && ((now - timerStart) >= duration);
+}
+
+boolean Sequencer::isRunning() {
+  return running;
+}
@@ -0,0 +1,124 @@
+/**
+ * \file sequencer.h
+ * \brief Show player of compact keyframe timelines
+ * 
+ * A show is a list of keyframes sorted by time. Every keyframe starts a
+ * linear transition of one track (the wheel speed, a light channel, a light
+ * servos group or the music trigger) to a new value, in the keyframe duration.
+ * The sequencer only returns the keyframes when they are due: the transitions
+ * are executed by the ramps and the fades of the state machine, so a tick costs
+ * at most SHOW_KEYS_PER_TICK keyframes plus the update of the tracks.
+ * 
+ * A keyframe is SHOW_KEYFRAME_LEN bytes, times in SHOW_TIME_UNIT ms:
+ * | time (2 bytes, big endian) | track | value | duration (2 bytes, big endian) |
+ * 
+ * The built-in shows are stored in flash (see shows.h). One more show can be
+ * received as a binary frame: the SHOW_FRAME_MAGIC byte, the number of
+ * keyframes and the keyframes.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SEQUENCER
+#define _SEQUENCER
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Write a keyframe in a show definition. Time and duration in ms
+#define KEYFRAME(time, track, value, duration) \
+  (byte)(((time) / SHOW_TIME_UNIT) >> 8), (byte)((time) / SHOW_TIME_UNIT), (byte)(track), (byte)(value), \
+  (byte)(((duration) / SHOW_TIME_UNIT) >> 8), (byte)((duration) / SHOW_TIME_UNIT)
+
+//! A show keyframe
+typedef struct {
+  unsigned long time;      ///< Time (ms) from the start of the show
+  int track;               ///< Track ID (SHOW_TRACK_xxx)
+  int value;               ///< Value to reach
+  unsigned long duration;  ///< Duration (ms) of the transition
+} Keyframe;
+
+//! Keyframe timelines player
+class Sequencer {
+  private:
+  //! Keyframes of the show playing
+  const byte* keyframes;
+  //! Number of keyframes of the show playing
+  int numKeyframes;
+  //! The keyframes are in flash
+  boolean inFlash;
+  //! Next keyframe to play
+  int cursor;
+  //! Time (ms) the show started
+  unsigned long timerStart;
+  //! Duration (ms) of the show, up to the end of the last transition
+  unsigned long duration;
+  //! The show is playing
+  boolean running;
+  //! Show received from remote
+  byte userShow[SHOW_MAX_KEYFRAMES * SHOW_KEYFRAME_LEN];
+  //! Number of keyframes of the show received from remote
+  int userKeyframes;
+
+  /**
+   * Read a keyframe of the show playing
+   * 
+   * @param j The keyframe index
+   * @param kf The keyframe read
+   */
+  void readKeyframe(int j, Keyframe &kf);
+
+  public:
+  Sequencer();
+
+  /**
+   * Load the show received from remote. The show is checked: the keyframes
+   * should be sorted by time and the tracks valid
+   * 
+   * @param frame The show frame
+   * @param length The frame length
+   * @return false if the frame is not valid or the remote show is playing
+   */
+  boolean load(const byte frame[], int length);
+
+  /**
+   * Start a show
+   * 
+   * @param show The show ID, a built-in show or SHOW_USER
+   * @param now The current time (ms)
+   * @return false if the show doesn't exist or it is empty
+   */
+  boolean start(int show, unsigned long now);
+
+  /**
+   * Stop the show
+   */
+  void stop();
+
+  /**
+   * Get the next keyframe due. Should be called until it returns false,
+   * up to SHOW_KEYS_PER_TICK times every tick
+   * 
+   * @param now The current time (ms)
+   * @param kf The keyframe due
+   * @return false if no keyframes are due
+   */
+  boolean next(unsigned long now, Keyframe &kf);
+
+  /**
+   * Return true if all the keyframes have been played and their
+   * transitions are completed
+   * 
+   * @param now The current time (ms)
+   */
+  boolean isFinished(unsigned long now);
+
+  /**
+   * Return true if a show is playing
+   */
+  boolean isRunning();
+};
+
+#endif
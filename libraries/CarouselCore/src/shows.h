@@ -0,0 +1,81 @@
+/**
+ * \file shows.h
+ * \brief Built-in shows, stored in flash
+ * 
+ * Every show is a list of keyframes sorted by time (see sequencer.h).
+ * The light levels are perceptual (see gamma.h), the light servos groups
+ * values are angles between MIN_ANGLE and MAX_ANGLE.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SHOWS
+#define _SHOWS
+
+#include "Arduino.h"
+#include "globals.h"
+#include "sequencer.h"
+
+//! Wave: the wheel turns while the two light groups cross each other
+const byte showWave[] PROGMEM = {
+  KEYFRAME(0, SHOW_TRACK_MUSIC, 1, 0),
+  KEYFRAME(0, SHOW_TRACK_LIGHT + LIGHT1, HIGH_LIGHT, 1500),
+  KEYFRAME(0, SHOW_TRACK_LIGHT + LIGHT2, HIGH_LIGHT, 1500),
+  KEYFRAME(0, SHOW_TRACK_LIGHT + LIGHT3, HIGH_LIGHT, 1500),
+  KEYFRAME(0, SHOW_TRACK_LIGHT + LIGHT4, HIGH_LIGHT, 1500),
+  KEYFRAME(500, SHOW_TRACK_WHEEL, WHEEL_CAROUSEL, 2000),
+  KEYFRAME(1000, SHOW_TRACK_GROUP, MAX_ANGLE, 3000),
+  KEYFRAME(1000, SHOW_TRACK_GROUP + 1, MIN_ANGLE, 3000),
+  KEYFRAME(4000, SHOW_TRACK_GROUP, MIN_ANGLE, 3000),
+  KEYFRAME(4000, SHOW_TRACK_GROUP + 1, MAX_ANGLE, 3000),
+  KEYFRAME(7000, SHOW_TRACK_GROUP, MAX_ANGLE, 3000),
+  KEYFRAME(7000, SHOW_TRACK_GROUP + 1, MIN_ANGLE, 3000),
+  KEYFRAME(7000, SHOW_TRACK_LIGHT + LIGHT2, LOW_LIGHT, 3000),
+  KEYFRAME(7000, SHOW_TRACK_LIGHT + LIGHT4, LOW_LIGHT, 3000),
+  KEYFRAME(10000, SHOW_TRACK_GROUP, MIN_ANGLE, 3000),
+  KEYFRAME(10000, SHOW_TRACK_GROUP + 1, MAX_ANGLE, 3000),
+  KEYFRAME(10000, SHOW_TRACK_LIGHT + LIGHT2, HIGH_LIGHT, 3000),
+  KEYFRAME(10000, SHOW_TRACK_LIGHT + LIGHT4, HIGH_LIGHT, 3000),
+  KEYFRAME(13000, SHOW_TRACK_WHEEL, WHEEL_STOP, 1500),
+  KEYFRAME(13000, SHOW_TRACK_LIGHT + LIGHT1, LOW_LIGHT, 2000),
+  KEYFRAME(13000, SHOW_TRACK_LIGHT + LIGHT2, LOW_LIGHT, 2000),
+  KEYFRAME(13000, SHOW_TRACK_LIGHT + LIGHT3, LOW_LIGHT, 2000),
+  KEYFRAME(13000, SHOW_TRACK_LIGHT + LIGHT4, LOW_LIGHT, 2000),
+  KEYFRAME(15000, SHOW_TRACK_MUSIC, 0, 0)
+};
+
+//! Pulse: the lights pulse in turn, nothing moves
+const byte showPulse[] PROGMEM = {
+  KEYFRAME(0, SHOW_TRACK_LIGHT + LIGHT1, HIGH_LIGHT, 500),
+  KEYFRAME(500, SHOW_TRACK_LIGHT + LIGHT1, LOW_LIGHT, 500),
+  KEYFRAME(500, SHOW_TRACK_LIGHT + LIGHT2, HIGH_LIGHT, 500),
+  KEYFRAME(1000, SHOW_TRACK_LIGHT + LIGHT2, LOW_LIGHT, 500),
+  KEYFRAME(1000, SHOW_TRACK_LIGHT + LIGHT3, HIGH_LIGHT, 500),
+  KEYFRAME(1500, SHOW_TRACK_LIGHT + LIGHT3, LOW_LIGHT, 500),
+  KEYFRAME(1500, SHOW_TRACK_LIGHT + LIGHT4, HIGH_LIGHT, 500),
+  KEYFRAME(2000, SHOW_TRACK_LIGHT + LIGHT4, LOW_LIGHT, 500),
+  KEYFRAME(2500, SHOW_TRACK_LIGHT + LIGHT1, HIGH_LIGHT, 1000),
+  KEYFRAME(2500, SHOW_TRACK_LIGHT + LIGHT2, HIGH_LIGHT, 1000),
+  KEYFRAME(2500, SHOW_TRACK_LIGHT + LIGHT3, HIGH_LIGHT, 1000),
+  KEYFRAME(2500, SHOW_TRACK_LIGHT + LIGHT4, HIGH_LIGHT, 1000),
+  KEYFRAME(4000, SHOW_TRACK_LIGHT + LIGHT1, LOW_LIGHT, 1500),
+  KEYFRAME(4000, SHOW_TRACK_LIGHT + LIGHT2, LOW_LIGHT, 1500),
+  KEYFRAME(4000, SHOW_TRACK_LIGHT + LIGHT3, LOW_LIGHT, 1500),
+  KEYFRAME(4000, SHOW_TRACK_LIGHT + LIGHT4, LOW_LIGHT, 1500)
+};
+
+//! A built-in show
+typedef struct {
+  const byte* keyframes;  ///< Keyframes in flash
+  int numKeyframes;       ///< Number of keyframes
+} ShowDefinition;
+
+//! Built-in shows, by show ID
+static const ShowDefinition builtinShows[NUMSHOWS] = {
+  { showWave, sizeof(showWave) / SHOW_KEYFRAME_LEN },
+  { showPulse, sizeof(showPulse) / SHOW_KEYFRAME_LEN }
+};
+
+#endif
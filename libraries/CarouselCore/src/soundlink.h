@@ -0,0 +1,96 @@
+/**
+ * \file soundlink.h
+ * \brief Framed serial link between the carousel board and the sound board
+ * 
+ * The MKR1000 (Serial1, pins 13 RX and 14 TX) and the sound Nano
+ * (SoftwareSerial on SOUND_LINK_RX_PIN and SOUND_LINK_TX_PIN) exchange
+ * 5 bytes frames:
+ * 
+ * SOUND_LINK_START CMD PARAM_H PARAM_L CHECK
+ * 
+ * where CHECK is the XOR of the previous four bytes. The carousel sends
+ * the SOUND_CMD_xxx commands, the sound board answers with the
+ * SOUND_EVT_xxx events. The same class is used on both the boards.
+ * 
+ * The link is considered connected while a valid frame has been received
+ * in the last SOUND_LINK_TIMEOUT ms; the carousel polls the status every
+ * SOUND_LINK_POLL ms so both sides see the link alive. When the link is
+ * not connected the sound board follows the music trigger pin, as before.
+ * 
+ * \warning The Nano TX is a 5V output, use a voltage divider on the
+ * MKR1000 RX pin.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SOUNDLINK
+#define _SOUNDLINK
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Frame of the serial link
+typedef struct {
+  byte cmd;                 ///< Command or event ID
+  unsigned int param;       ///< Command or event parameter
+} LinkFrame;
+
+//! Serial link frames encoder and decoder
+class SoundLink {
+  private:
+  //! Serial connected to the other board
+  Stream *serial;
+  //! Incoming frame
+  byte frame[SOUND_LINK_FRAME_LEN];
+  //! Number of bytes of the incoming frame received
+  int frameLen;
+  //! Time (ms) the last valid frame has been received
+  unsigned long timerReceived;
+  //! True if at least a valid frame has been received
+  boolean received;
+  //! Number of corrupted frames discarded
+  unsigned int errors;
+
+  public:
+  SoundLink();
+
+  /**
+   * Set the serial connected to the other board
+   * 
+   * @param s The serial, already initialized at SOUND_LINK_SPEED
+   */
+  void begin(Stream &s);
+
+  /**
+   * Send a frame
+   * 
+   * @param cmd The command or event ID
+   * @param param The command or event parameter
+   */
+  void send(byte cmd, unsigned int param);
+
+  /**
+   * Read the incoming bytes until a complete frame is found. Never waits
+   * 
+   * @param f The frame received
+   * @param now The current time (ms)
+   * @return true if a valid frame has been received
+   */
+  boolean read(LinkFrame &f, unsigned long now);
+
+  /**
+   * Return true if a valid frame has been received recently
+   * 
+   * @param now The current time (ms)
+   */
+  boolean isConnected(unsigned long now);
+
+  /**
+   * Get the number of corrupted frames discarded
+   */
+  unsigned int getErrors();
+};
+
+#endif
@@ -0,0 +1,719 @@
+/**
+ * \file stateMachine.cpp
+ * \briuef Carousel state machine methods. Integrates remote commands via MQTT protocol
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "statemachine.h"
+
+//! PIR edges, written by the PIR interrupt and read by the state machine
+static PirQueue pirEdges;
+
+void StateMachine::initStatus() {
+  m_Status.pir = false;
+  m_Status.pirLevel = digitalRead(PIR_PIN);
+  m_Status.pirPending = m_Status.pirLevel;
+  m_Status.pirEdge = millis();
+  m_Status.pirDetection = 0;
+  m_Status.music = false;
+  m_Status.mqtt = false;
+  m_Status.mqttCommand.id = 0;
+  m_Status.mqttStep = MQTT_STEP_IDLE;
+  m_Status.mqttSongs = 0;
+  m_Status.wheel = 0;
+  m_Status.light = LOW_LIGHT;
+  m_Status.timerStart = millis();
+  m_Status.wheel = WHEEL_STOP;
+  m_Status.isRotating = false;
+  m_Status.timerServo = millis();
+  m_Status.sweepProfile = SWEEP_PROFILE;
+  m_Status.sweepStep = 0;
+  setSweepPositions();
+  m_Presence.begin(millis());
+  memset(&m_Power, 0, sizeof(m_Power));
+  m_Power.timerStart = millis();
+  m_IdleSince = millis();
+  m_Sound.track = 0;
+  m_Sound.lastEnded = 0;
+  m_Sound.ended = 0;
+  m_SoundPoll = millis();
+}
+
+void StateMachine::setProfiler(Profiler *p) {
+  m_Profiler = p;
+}
+
+void StateMachine::initHardware() {
+  pinMode(MUSIC_TRIGGER_PIN, OUTPUT);
+  pinMode(PIR_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(PIR_PIN), pirInterrupt, CHANGE);
+
+  // Set the light pins and attach the servos
+  m_Outputs.begin();
+
+  // The player trigger is active low, keep the music stopped
+  m_Outputs.writeDigital(MUSIC_TRIGGER_PIN, HIGH);
+
+  // Serial link with the sound board
+  Serial1.begin(SOUND_LINK_SPEED);
+  m_SoundLink.begin(Serial1);
+
+  // Initialize the lights to the minimum value
+  m_Fader.begin(LOW_LIGHT);
+  m_Fader.update(m_Outputs, millis());
+
+  // Position the four light servos at the initial point
+  m_Outputs.writeServo(LIGHT1, m_Status.servoPos[LIGHT1]);
+  m_Outputs.writeServo(LIGHT2, m_Status.servoPos[LIGHT2]);
+  m_Outputs.writeServo(LIGHT3, m_Status.servoPos[LIGHT3]);
+  m_Outputs.writeServo(LIGHT4, m_Status.servoPos[LIGHT4]);
+
+  // Set the wheel stopped
+  m_WheelRamp.begin(WHEEL_STOP);
+  m_Outputs.writeServo(WHEEL, WHEEL_STOP);
+}
+
+void StateMachine::updateHardware() {
+  // Keep the PIR level updated also while the carousel is running
+  updatePirLevel();
+
+  // Read the sound board events
+  updateSoundLink();
+
+  // Check for the PIR conditional hardware changes
+  if( (m_Status.pir == true) && (m_Status.isRotating == false) ){
+    // Should start the rotating wheel
+    m_Status.isRotating = true;
+    setWheelRotation();
+    setLightIntensity();
+  } else {
+    if( (m_Status.pir == false) && (m_Status.isRotating == true) ){
+      // Stop the rotating wheel
+      m_Status.isRotating = false;
+      setWheelRotation();
+      setLightIntensity();
+    } // No pir and wheel rotates
+  } // Pir rotates and wheel is stopped
+
+  // Follow the wheel speed ramp. Only the speed changes
+  // are written to the servo
+  m_Outputs.writeServo(WHEEL, m_WheelRamp.update(millis()));
+
+  // Advance the lights fades
+  m_Fader.update(m_Outputs, millis());
+
+  // Check for the light servo rotation interval
+  // end eventually moved the servos
+  if(m_Status.pir == true) {
+    servoLightTimeToMove();
+  }
+
+  // Play the show, if any
+  if(m_Show.isRunning()) {
+    updateShow();
+  }
+
+  // Advance the scheduled tasks (remote command sequences)
+  m_Scheduler.run(millis());
+}
+
+void StateMachine::setWheelRotation() {
+  int current = m_WheelRamp.getValue();
+  unsigned long ms;
+
+  // Use the acceleration or deceleration time, proportionally
+  // to the speed change
+  if(abs(m_Status.wheel - WHEEL_STOP) > abs(current - WHEEL_STOP)) {
+    ms = WHEEL_ACCEL_TIME;
+  } else {
+    ms = WHEEL_DECEL_TIME;
+  }
+  ms = ms * abs(m_Status.wheel - current) / abs(WHEEL_CAROUSEL - WHEEL_STOP);
+  m_WheelRamp.setTarget(m_Status.wheel, ms, WHEEL_RAMP_CURVE, millis());
+  m_Timeline.record(millis(), TRANSITION_WHEEL, m_Status.wheel);
+}
+
+void StateMachine::setMusicTrigger(boolean play) {
+  // The player trigger is active low
+  if(play == true) {
+    m_Outputs.writeDigital(MUSIC_TRIGGER_PIN, LOW);
+  } else {
+    m_Outputs.writeDigital(MUSIC_TRIGGER_PIN, HIGH);
+  }
+  if(m_Status.music != play) {
+    m_Status.music = play;
+    m_Timeline.record(millis(), TRANSITION_MUSIC, play);
+    // The sound board ignores the trigger while the link is connected
+    if(isSoundLinked()) {
+      if(play == true) {
+        m_SoundLink.send(SOUND_CMD_NEXT, 0);
+      } else {
+        m_SoundLink.send(SOUND_CMD_FADE, SOUND_FADE_OUT);
+      }
+    }
+  }
+}
+
+void StateMachine::pirInterrupt() {
+  pirEdges.push(millis(), digitalRead(PIR_PIN));
+}
+
+void StateMachine::updatePirLevel() {
+  PirEdge edge;
+
+  // Keep only the last level change, the previous were too
+  // short to be accepted
+  while(pirEdges.pop(edge)) {
+    m_Status.pirPending = edge.level;
+    m_Status.pirEdge = edge.time;
+    // Time to notice the edge, e.g. while sleeping
+    if( (millis() - edge.time) > m_Power.maxWakeLatency) {
+      m_Power.maxWakeLatency = millis() - edge.time;
+    }
+  }
+  // Some edges has been lost, read the current level
+  if(pirEdges.checkOverflow()) {
+    m_Status.pirPending = digitalRead(PIR_PIN);
+    m_Status.pirEdge = millis();
+  }
+  // Accept the new level when it is stable
+  if( (m_Status.pirPending != m_Status.pirLevel) &&
+      ((millis() - m_Status.pirEdge) >= PIR_DEBOUNCE) ) {
+    m_Status.pirLevel = m_Status.pirPending;
+    if(m_Status.pirLevel == true) {
+      m_Status.pirDetection = m_Status.pirEdge;
+    }
+  }
+  // Follow the presence also while the carousel is running
+  m_Presence.update(m_Status.pirLevel, millis());
+}
+
+void StateMachine::checkPirStatus() {
+  updatePirLevel();
+  // The remote commands inhibit the PIR sensor until
+  // the command sequences have not been completed
+  if( (m_Status.mqtt == true) || !m_Commands.isEmpty() ) {
+    return;
+  }
+  // Check for motion. Nothing to do if the carousel is already
+  // running, there is no presence or the last cycle just ended
+  if( (m_Status.pirLevel == true) && (m_Status.pir == false) &&
+      (m_Presence.getCoolDown(millis()) == 0) ) {
+    // Motion detected, trigger the mp3 player
+    // and start the timeout counter
+    setMusicTrigger(true);
+    setLight(HIGH_LIGHT);
+    setWheelSpeed(WHEEL_CAROUSEL);
+    m_Status.timerStart = millis();
+    m_Presence.cycleStart(millis());
+    setPir(true);
+  }
+}
+
+void StateMachine::endCarousel() {
+  // Start the cool down after a cycle
+  if(m_Status.pir == true) {
+    m_Presence.cycleEnd(millis());
+  }
+  // Disable the pir status
+  setPir(false);
+  // Reset the mp3 player trigger and disable the other stuff
+  setMusicTrigger(false);
+  setLight(LOW_LIGHT);
+  setWheelSpeed(WHEEL_STOP);
+}
+
+void StateMachine::mqttCheckStatus() {
+  // Start the next command only when the running sequence, if any,
+  // has been completed
+  if( (m_Status.mqttStep == MQTT_STEP_IDLE) && m_Commands.pop(m_Status.mqttCommand) ) {
+    mqttSetMqtt(true);
+    // If PIR status is on, disable it and stop the carousel
+    // preparing to execute the mqtt command request
+    if(m_Status.pir == true) {
+      endCarousel();
+    } // Stop the carousel to execute the command
+    // Launch the requested MQTT command
+    m_Timeline.record(millis(), TRANSITION_MQTT, m_Status.mqttCommand.id);
+    mqttExecCommand();
+  }
+}
+
+void StateMachine::mqttExecCommand() {
+  // Set the action and flags accordingly with the command ID
+  switch(m_Status.mqttCommand.id) {
+    case MQTTCMD_LIGTHS:
+      if(m_Status.mqttCommand.duration > 0) {
+        mqttCmdLights(m_Status.mqttCommand.duration);
+      } else {
+        mqttCmdLights(MQTT_LIGHTS_TIMEOUT);
+      }
+    break;
+    case MQTTCMD_MUSIC:
+      // The level of the music command is the player max volume
+      if( (m_Status.mqttCommand.level > 0) && isSoundLinked() ) {
+        m_SoundLink.send(SOUND_CMD_VOLUME, m_Status.mqttCommand.level);
+      }
+      mqttCmdMusic();
+    break;
+    case MQTTCMD_RUN:
+      mqttCmdRun();
+    break;
+    case MQTTCMD_SHOW:
+      mqttCmdShow();
+    break;
+    default:
+      // Unknown command, nothing to execute
+      mqttEndCarousel();
+    break;
+  }
+}
+
+void StateMachine::mqttCmdMusic() {
+  // Play a series of pieces for a short time
+  // starting by the next after the current piece
+  if(m_Status.mqttCommand.count > 0) {
+    m_Status.mqttSongs = m_Status.mqttCommand.count;
+  } else {
+    m_Status.mqttSongs = MQTT_MUSIC_PLAY_SONGS;
+  }
+  m_Status.mqttStep = MQTT_STEP_SONG_ON;
+  mqttScheduleStep(0);
+}
+
+void StateMachine::mqttCmdLights(int to) {
+  // Lights on, then off after the command lenght
+  mqttCmdLights();
+  m_Status.mqttStep = MQTT_STEP_LIGHTS_OFF;
+  mqttScheduleStep(to * 1000UL);
+}
+
+void StateMachine::mqttCmdLights() {
+  // Set lights intensity
+  if(m_Status.mqttCommand.level > 0) {
+    setLight(m_Status.mqttCommand.level);
+  } else {
+    setLight(HIGH_LIGHT);
+  }
+  // Show the lights and light servos running
+  setLightIntensity();
+}
+
+void StateMachine::mqttCmdRun() {
+  // Power on the lights
+  mqttCmdLights();
+  // Start a music cycle. The lights are powered off
+  // when the songs sequence ends
+  mqttCmdMusic();
+}
+
+void StateMachine::mqttCmdShow() {
+  int j;
+
+  if(!m_Show.start(m_Status.mqttCommand.level, millis())) {
+    // Unknown or empty show
+    mqttEndCarousel();
+    return;
+  }
+  // The groups start from the current servos position
+  for(j = 0; j < NUMSERVOGROUPS; j++) {
+    m_GroupRamps[j].begin(m_Status.servoPos[servoGroups[j].servos[0]]);
+  }
+  m_Status.mqttStep = MQTT_STEP_SHOW;
+}
+
+boolean StateMachine::mqttLoadShow(const byte frame[], int length) {
+  return m_Show.load(frame, length);
+}
+
+void StateMachine::updateShow() {
+  Keyframe kf;
+  int j, k;
+  int pos;
+  unsigned long now = millis();
+
+  // Limited number of keyframes every tick, the others
+  // start the next loop cycle
+  for(j = 0; (j < SHOW_KEYS_PER_TICK) && m_Show.next(now, kf); j++) {
+    startKeyframe(kf);
+  }
+
+  // Move the light servos groups
+  for(j = 0; j < NUMSERVOGROUPS; j++) {
+    pos = m_GroupRamps[j].update(now);
+    for(k = 0; k < servoGroups[j].numServos; k++) {
+      m_Status.servoPos[servoGroups[j].servos[k]] = pos;
+      m_Outputs.writeServo(servoGroups[j].servos[k], pos);
+    }
+  }
+
+  if(m_Show.isFinished(now)) {
+    // Whatever the show did, go back to the idle status
+    m_Show.stop();
+    m_Status.mqttStep = MQTT_STEP_IDLE;
+    setWheelSpeed(WHEEL_STOP);
+    m_WheelRamp.setTarget(WHEEL_STOP, WHEEL_DECEL_TIME, WHEEL_RAMP_CURVE, now);
+    setLight(LOW_LIGHT);
+    setLightIntensity();
+    mqttEndCarousel();
+  }
+}
+
+void StateMachine::startKeyframe(Keyframe &kf) {
+  unsigned long now = millis();
+  int wheel;
+
+  if(kf.track == SHOW_TRACK_WHEEL) {
+    // A show can't turn the wheel backwards or faster than the carousel
+    wheel = constrain(kf.value, WHEEL_STOP, WHEEL_CAROUSEL);
+    setWheelSpeed(wheel);
+    m_WheelRamp.setTarget(wheel, kf.duration, RAMP_LINEAR, now);
+    m_Timeline.record(now, TRANSITION_WHEEL, wheel);
+  } else if(kf.track < SHOW_TRACK_GROUP) {
+    m_Fader.setChannel(kf.track - SHOW_TRACK_LIGHT, kf.value, kf.duration, now);
+  } else if(kf.track < SHOW_TRACK_MUSIC) {
+    m_GroupRamps[kf.track - SHOW_TRACK_GROUP].setTarget(constrain(kf.value, MIN_ANGLE, MAX_ANGLE),
+                                                        kf.duration, RAMP_LINEAR, now);
+  } else {
+    setMusicTrigger(kf.value != 0);
+  }
+}
+
+void StateMachine::mqttScheduleStep(unsigned long ms) {
+  m_Scheduler.addTimeout(mqttStepTask, this, ms, millis());
+}
+
+void StateMachine::mqttStepTask(void* context) {
+  static_cast<StateMachine*>(context)->mqttStepCommand();
+}
+
+void StateMachine::mqttStepCommand() {
+  switch(m_Status.mqttStep) {
+    case MQTT_STEP_SONG_ON:
+      // Enable the player for the short time
+      setMusicTrigger(true);
+      m_Status.mqttStep = MQTT_STEP_SONG_OFF;
+      if(m_Status.mqttCommand.duration > 0) {
+        mqttScheduleStep(m_Status.mqttCommand.duration * 1000UL);
+      } else {
+        mqttScheduleStep(MQTT_MUSIC_TIMEOUT * 1000UL);
+      }
+    break;
+    case MQTT_STEP_SONG_OFF:
+      m_Status.mqttSongs--;
+      if( (m_Status.mqttSongs > 0) && isSoundLinked() ) {
+        // Move to the next song with a single command, the
+        // trigger stays set
+        m_SoundLink.send(SOUND_CMD_NEXT, 0);
+        if(m_Status.mqttCommand.duration > 0) {
+          mqttScheduleStep(m_Status.mqttCommand.duration * 1000UL);
+        } else {
+          mqttScheduleStep(MQTT_MUSIC_TIMEOUT * 1000UL);
+        }
+        break;
+      }
+      // Disable the player and move to the next song
+      setMusicTrigger(false);
+      if(m_Status.mqttSongs > 0) {
+        m_Status.mqttStep = MQTT_STEP_SONG_ON;
+      } else {
+        m_Status.mqttStep = MQTT_STEP_LIGHTS_OFF;
+      }
+      // Time to accept the command
+      mqttScheduleStep(MQTT_TRIGGER_DELAY);
+    break;
+    case MQTT_STEP_LIGHTS_OFF:
+      // The volume set by the music command was for this sequence
+      // only, give it back to the sound board trimmer
+      if( (m_Status.mqttCommand.id == MQTTCMD_MUSIC) && (m_Status.mqttCommand.level > 0) &&
+          isSoundLinked() ) {
+        m_SoundLink.send(SOUND_CMD_VOLUME, 0);
+      }
+      // Lights off and sequence completed
+      setLight(LOW_LIGHT);
+      setLightIntensity();
+      m_Status.mqttStep = MQTT_STEP_IDLE;
+      mqttEndCarousel();
+    break;
+  }
+}
+
+boolean StateMachine::mqttSetCommand(int cmd) {
+  MqttCommand command;
+
+  command.id = cmd;
+  command.seq = 0;
+  command.priority = CMD_PRIORITY_DEFAULT;
+  command.duration = 0;
+  command.level = 0;
+  command.count = 0;
+  return m_Commands.push(command);
+}
+
+boolean StateMachine::mqttSetCommand(MqttCommand &cmd) {
+  return m_Commands.push(cmd);
+}
+
+CommandQueue& StateMachine::getCommandQueue() {
+  return m_Commands;
+}
+
+void StateMachine::mqttEndCarousel() {
+  if(m_Status.mqtt == true) {
+    m_Timeline.record(millis(), TRANSITION_MQTT, 0);
+  }
+  mqttSetMqtt(false);
+  endCarousel();
+}
+
+void StateMachine::setLightIntensity() {
+  m_Fader.setAll(m_Status.light, LIGHT_FADE_TIME, millis());
+  m_Timeline.record(millis(), TRANSITION_LIGHT, m_Status.light);
+}
+
+void StateMachine::servoLightTimeToMove() {
+  // Check the elapsed time in milliseconds
+  if( (millis() - m_Status.timerServo) >= SERVO_CYCLE) {
+    // Time passes, servos should move
+    if(m_Profiler != NULL) {
+      m_Profiler->addServoLateness(millis() - m_Status.timerServo - SERVO_CYCLE);
+    }
+    stepLightServo();
+    m_Status.timerServo = millis(); // Update the time reading
+  }
+}
+
+void StateMachine::stepLightServo() {
+  int j;
+
+  // Move to the next step of the sweep
+  m_Status.sweepStep++;
+  if(m_Status.sweepStep >= SWEEP_STEPS) {
+    m_Status.sweepStep = 0;
+    m_Timeline.record(millis(), TRANSITION_SWEEP, m_Status.sweepProfile);
+  }
+  setSweepPositions();
+
+  // Update the servos position
+  for(j = 0; j < NUMLIGHTS; j++) {
+    m_Outputs.writeServo(j, m_Status.servoPos[j]);
+  }
+}
+
+void StateMachine::setSweepPositions() {
+  int j, k;
+  int step;
+  int pos;
+
+  // One table read for every group, all the servos of the group
+  // are in the same position
+  for(j = 0; j < NUMSERVOGROUPS; j++) {
+    step = m_Status.sweepStep + servoGroups[j].offset;
+    if(step >= SWEEP_STEPS) {
+      step -= SWEEP_STEPS;
+    }
+    pos = SweepTable::positions[m_Status.sweepProfile][step];
+    for(k = 0; k < servoGroups[j].numServos; k++) {
+      m_Status.servoPos[servoGroups[j].servos[k]] = pos;
+    }
+  }
+}
+
+// -------- Getters and setters
+
+void StateMachine::mqttSetMqtt(boolean s) {
+  m_Status.mqtt = s;
+}
+
+void StateMachine::setPir(boolean s) {
+  if(m_Status.pir != s) {
+    m_Timeline.record(millis(), TRANSITION_PIR, s);
+  }
+  m_Status.pir = s;
+}
+
+void StateMachine::setWheelSpeed(int s) {
+  m_Status.wheel = s;
+}
+
+void StateMachine::setLight(int i) {
+  m_Status.light = i;
+}
+
+void StateMachine::setLightChannel(int j, int level, unsigned long ms) {
+  if( (j >= 0) && (j < NUMLIGHTS) ) {
+    m_Fader.setChannel(j, level, ms, millis());
+  }
+}
+
+void StateMachine::setSweepProfile(int p) {
+  if( (p >= 0) && (p < NUMSWEEPS) ) {
+    m_Status.sweepProfile = p;
+  }
+}
+
+int StateMachine::getSweepProfile() {
+  return m_Status.sweepProfile;
+}
+int StateMachine::getElapsed() {
+  return int( (millis() - m_Status.timerStart) / 1000);
+}
+
+boolean StateMachine::mqttIsMqtt() {
+  return m_Status.mqtt;
+}
+
+boolean StateMachine::mqttIsRunning() {
+  return m_Status.mqttStep != MQTT_STEP_IDLE;
+}
+
+unsigned long StateMachine::getNextEventDelay() {
+  unsigned long now = millis();
+  unsigned long next = m_Scheduler.getNextDelay(now);
+  unsigned long elapsed;
+
+  // The ramps change the wheel speed and the lights continuously
+  if(m_WheelRamp.isRunning() || m_Fader.isRunning()) {
+    next = min(next, 1UL);
+  }
+  // The show moves the light servos continuously
+  if(m_Show.isRunning()) {
+    next = min(next, 1UL);
+  }
+
+  // PIR level change waiting to be accepted
+  if(m_Status.pirPending != m_Status.pirLevel) {
+    elapsed = now - m_Status.pirEdge;
+    if(elapsed >= PIR_DEBOUNCE) {
+      return 0;
+    }
+    next = min(next, PIR_DEBOUNCE - elapsed);
+  }
+
+  if(m_Status.pir == true) {
+    // Next light servos step
+    elapsed = now - m_Status.timerServo;
+    if(elapsed >= SERVO_CYCLE) {
+      return 0;
+    }
+    next = min(next, SERVO_CYCLE - elapsed);
+    // End of the carousel cycle, moved forward by the motion
+    next = min(next, m_Presence.getTimeLeft(now));
+  } else if(m_Status.pirLevel == true) {
+    // Detection waiting for the end of the cool down
+    next = min(next, m_Presence.getCoolDown(now));
+  } // Carousel is running
+  return next;
+}
+
+Timeline& StateMachine::getTimeline() {
+  return m_Timeline;
+}
+
+Outputs& StateMachine::getOutputs() {
+  return m_Outputs;
+}
+
+boolean StateMachine::isPir() {
+  return m_Status.pir;
+}
+
+boolean StateMachine::isIdle() {
+  if( (m_Status.pir == true) || m_WheelRamp.isRunning() || m_Fader.isRunning() ) {
+    return false;
+  }
+  if( (m_Status.mqtt == true) || !m_Commands.isEmpty() ) {
+    return false;
+  }
+  return true;
+}
+
+void StateMachine::idle() {
+  unsigned long now = millis();
+  unsigned long wait;
+
+  if(!isIdle()) {
+    m_IdleSince = now;
+    return;
+  }
+
+  // Nothing moves, power off the servos
+  if( ((now - m_IdleSince) >= IDLE_DETACH_DELAY) && m_Outputs.isServoAttached() ) {
+    m_Outputs.detachServos();
+    m_Power.detaches++;
+  }
+
+  // Sleep until the next event. The PIR interrupt ends the sleep
+  wait = min(getNextEventDelay(), IDLE_MAX_SLEEP);
+  m_Power.sleeps++;
+  while( ((millis() - now) < wait) && pirEdges.isEmpty() ) {
+    waitForInterrupt();
+  }
+  if(!pirEdges.isEmpty()) {
+    m_Power.wakeups++;
+  }
+  m_Power.sleepTime += millis() - now;
+}
+
+PowerStats StateMachine::getPowerStats() {
+  return m_Power;
+}
+
+void StateMachine::updateSoundLink() {
+  LinkFrame f;
+  unsigned long now = millis();
+
+  // Poll the sound board, the answers keep the link alive
+  if((now - m_SoundPoll) >= SOUND_LINK_POLL) {
+    m_SoundPoll = now;
+    m_SoundLink.send(SOUND_CMD_STATUS, 0);
+  }
+
+  while(m_SoundLink.read(f, now)) {
+    switch(f.cmd) {
+      case SOUND_EVT_STATUS:
+        m_Sound.track = f.param;
+      break;
+      case SOUND_EVT_ENDED:
+        m_Sound.lastEnded = f.param;
+        m_Sound.ended++;
+        m_Timeline.record(now, TRANSITION_SOUND_END, f.param);
+      break;
+    }
+  }
+}
+
+SoundStatus StateMachine::getSoundStatus() {
+  return m_Sound;
+}
+
+boolean StateMachine::isSoundLinked() {
+  return m_SoundLink.isConnected(millis());
+}
+
+boolean StateMachine::isCycleEnd() {
+  return (m_Status.pir == true) && (m_Presence.getTimeLeft(millis()) == 0);
+}
+
+unsigned long StateMachine::getPirDetection() {
+  return m_Status.pirDetection;
+}
+
+int StateMachine::getWheel() {
+  return m_WheelRamp.getValue();
+}
+
+int StateMachine::getWheelTarget() {
+  return m_Status.wheel;
+}
+
+int StateMachine::getLight() {
+  return m_Status.light;
+}
+
+int StateMachine::getServoPos(int j) {
+  return m_Status.servoPos[j];
+}
@@ -0,0 +1,495 @@
+/**
+ * \file stateMachine.h
+ * \briuef Carousel state machine methods. Integrates remote commands via MQTT protocol
+ * 
+ * This version of the StateMachine class include the optoins of remote commands
+ * They can be used in any way by the program but these are sort of "dmoe" funcionts with
+ * shorter duration. Their typical usage is to show the features of the carousel when they
+ * are managed from remote. Remote control acts through the MQTT protocol.\n
+ * For better understanding the remote command methods have the prefix "mqtt" 
+ * 
+ * The remote commands are compiled only when the sketch configuration selects
+ * a network layer (see config.h), so the stand alone carousel doesn't pay for them.
+ * 
+ * \note the remote commands interact with the state of the mqtt flag in the state machine
+ * structure MachineStatus (flag mqtt) and automatically disable the PIR sensor effect.
+ * When a remote command is received the mqtt flag is enabled, and inhibits the PIR sensor
+ * until the remote command seqence has not been completed. The local behavior controller
+ * by the PIR sensor and the mqtt remote commands are mutually exclusive.
+ * 
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _STATEMACHINE
+#define _STATEMACHINE
+
+#include "globals.h"
+#include "structs.h"
+#include "profiler.h"
+#include "outputs.h"
+#include "sweep.h"
+#include "ramp.h"
+#include "fader.h"
+#include "cmdqueue.h"
+#include "sequencer.h"
+#include "scheduler.h"
+#include "timeline.h"
+#include "pirqueue.h"
+#include "presence.h"
+#include "power.h"
+#include "soundlink.h"
+
+//! The state machine class control the behavior of all the hardware and the
+//! logic of movements accordingly with the PIR sensor
+class StateMachine {
+  private:
+  //! Servos, lights and digital outputs. All the hardware writes pass
+  //! through it, so the redundant writes never reach the hardware
+  Outputs m_Outputs;
+
+  //! Light servos groups. The servos of a group move together following
+  //! the sweep profile, shifted by the group offset
+  ServoGroup servoGroups[NUMSERVOGROUPS] = {
+    { { LIGHT1, LIGHT3 }, 2, 0 },
+    { { LIGHT2, LIGHT4 }, 2, SWEEP_HALF }
+  };
+
+  //! Machine status
+  MachineStatus m_Status;
+
+  //! Lights fade engine. The lights follow the fade levels
+  //! instead of jumping to the new intensity
+  LightFader m_Fader;
+
+  //! Wheel speed ramp. The wheel servo follows the ramp value
+  //! instead of jumping to the new speed
+  Ramp m_WheelRamp;
+
+  //! Timeline of the last status transitions
+  Timeline m_Timeline;
+
+  //! Presence model. Decides when the carousel cycle ends
+  Presence m_Presence;
+
+  //! Idle and sleep statistics
+  PowerStats m_Power;
+
+  //! Time (ms) the machine became idle
+  unsigned long m_IdleSince;
+
+  //! Serial link with the sound board
+  SoundLink m_SoundLink;
+
+  //! Sound board status, as notified on the link
+  SoundStatus m_Sound;
+
+  //! Time (ms) of the last sound board status request
+  unsigned long m_SoundPoll;
+
+  //! Tasks scheduler. The remote command sequences are executed by
+  //! steps scheduled here instead of waiting with delay()
+  Scheduler m_Scheduler;
+
+  //! Remote commands waiting to be executed
+  CommandQueue m_Commands;
+
+  //! Shows player
+  Sequencer m_Show;
+
+  //! Light servos groups positions while a show is playing
+  Ramp m_GroupRamps[NUMSERVOGROUPS];
+
+  //! Loop profiler of the sketch, NULL if not instrumented
+  Profiler *m_Profiler = NULL;
+
+  /**
+   * Start the keyframes due and move the light servos groups
+   * of the show playing. Close the show when it is finished
+   */
+  void updateShow();
+
+  /**
+   * Start the transition of a keyframe
+   * 
+   * @param kf The keyframe
+   */
+  void startKeyframe(Keyframe &kf);
+
+  /**
+   * Schedule the next step of the running remote command sequence
+   * 
+   * @param ms Delay (ms) before the step is executed
+   */
+  void mqttScheduleStep(unsigned long ms);
+
+  /**
+   * Execute the current step of the remote command sequence and
+   * schedule the next one, if any.
+   */
+  void mqttStepCommand();
+
+  /**
+   * Scheduler callback executing the sequence steps
+   * 
+   * @param context The state machine instance
+   */
+  static void mqttStepTask(void* context);
+
+  /**
+   * Set the speed of the wheel (rotating servo) accordingly with the
+   * status of the machine. The speed changes gradually: a ramp to the
+   * new speed is started and the servo is updated by updateHardware()
+   */
+  void setWheelRotation();
+
+  /**
+   * Update the light intensity, accordingly with
+   * the machine status light value. All the lights fade to the new
+   * intensity in LIGHT_FADE_TIME ms, advanced by updateHardware()
+   */
+  void setLightIntensity();
+
+  /**
+   * Process the PIR edges queued by the interrupt and update the debounced
+   * PIR level. A new level is accepted when it has been stable for PIR_DEBOUNCE
+   * milliseconds.
+   */
+  void updatePirLevel();
+
+  /**
+   * PIR sensor interrupt routine. Queue the level change with its time
+   */
+  static void pirInterrupt();
+
+  /**
+   * Set the music trigger pin. The music plays while the trigger is active.
+   * When the sound board link is connected the player is also commanded
+   * on the link: next track to play, fade out to stop
+   * 
+   * @param play True to start the player, false to stop it
+   */
+  void setMusicTrigger(boolean play);
+
+  /**
+   * Poll the sound board status and read its events
+   */
+  void updateSoundLink();
+
+  /**
+   * Check if the delaty between two 1 Deg light servo rotation
+   * has passed. If the delay has been reached the servo(s) are moved
+   * by one step and the time counter is updated.
+   */
+  void servoLightTimeToMove();
+
+  /**
+   * Update the ligth servos position by one step
+   */
+  void stepLightServo();
+
+  /**
+   * Calculate the light servos positions of the current sweep step
+   */
+  void setSweepPositions();
+
+  public:
+  /**
+   * Return the time elapsed (in seconds) after the last rime reading. Time is 
+   * read when the PIR status changes due a motion detection. The internal calculations
+   * are done with unsigned long milliseconds while the result is in int seconds
+   * 
+   * @return the elapsed time in seconds
+   */
+  int getElapsed();
+
+  /**
+   * Return true or false accordingly with the current pir status. After motion has been deteced
+   * the sensor status persists until the end of the cycle (see isCycleEnd())
+   * 
+   * @return the sensor status
+   */
+  boolean isPir();
+
+  /**
+   * Return true if the running carousel cycle should stop. The cycle is
+   * extended while the PIR sensor detects motion, between PRESENCE_MIN_CYCLE
+   * and PRESENCE_MAX_CYCLE ms
+   */
+  boolean isCycleEnd();
+
+  /**
+   * Return true if nothing is running: no carousel cycle, no ramps or
+   * fades and no remote commands
+   */
+  boolean isIdle();
+
+  /**
+   * Low power idle. Should be called at the end of every loop cycle. If the
+   * machine is idle the servos are detached after IDLE_DETACH_DELAY ms and
+   * the processor sleeps until a PIR edge, the next internal event or
+   * IDLE_MAX_SLEEP ms. Returns immediately if the machine is not idle
+   */
+  void idle();
+
+  /**
+   * Get the idle and sleep statistics
+   */
+  PowerStats getPowerStats();
+
+  /**
+   * Get the sound board status, as notified on the serial link
+   */
+  SoundStatus getSoundStatus();
+
+  /**
+   * Return true if the sound board answers on the serial link
+   */
+  boolean isSoundLinked();
+
+  /**
+   * Return true or false accordingly with the remote command status (mqtt flagh).
+   * 
+   * @return the mqtt remote command flag status
+   */
+  boolean mqttIsMqtt();
+
+  /**
+   * Return true if a remote command sequence is in progress
+   */
+  boolean mqttIsRunning();
+
+  /**
+   * Return the time left before the next internal event: a light servo step,
+   * the end of the carousel cycle, a PIR level change waiting for the debounce
+   * or a scheduled task. Without external events
+   * (PIR, remote commands) the status of the machine doesn't change before this
+   * time, so a virtual clock can be moved forward by this amount.
+   * 
+   * @return the delay (ms), or NO_EVENT if the machine is idle
+   */
+  unsigned long getNextEventDelay();
+
+  /**
+   * Get the timeline of the last status transitions
+   */
+  Timeline& getTimeline();
+
+  /**
+   * Get the hardware outputs, e.g. to read the write counters
+   */
+  Outputs& getOutputs();
+
+  /**
+   * Return the time (ms) of the last motion detection, as read by the
+   * PIR interrupt
+   */
+  unsigned long getPirDetection();
+
+  /**
+   * Get the current wheel speed, as commanded to the servo during the ramps
+   */
+  int getWheel();
+
+  /**
+   * Get the wheel speed the ramp is going to
+   */
+  int getWheelTarget();
+
+  /**
+   * Get the current light level
+   */
+  int getLight();
+
+  /**
+   * Get the current position of a light servo
+   * 
+   * @param j The light servo index
+   */
+  int getServoPos(int j);
+
+  /**
+   * Set the pir status. Logical value depends on the last hardware read
+   */
+  void setPir(boolean s);
+
+  /**
+   * Set the remote command mqtt flag status.
+   */
+  void mqttSetMqtt(boolean s);
+
+  /**
+   * Set the current wheel speed
+   */
+  void setWheelSpeed(int s);
+
+  /**
+   * Set the current light intensity
+   * 
+   * @param i light intensity
+   */
+  void setLight(int i);
+
+  /**
+   * Fade a single light channel to a new level, independently from the
+   * machine status light value
+   * 
+   * @param j The light channel
+   * @param level The perceptual light level (0-255)
+   * @param ms The fade duration (ms)
+   */
+  void setLightChannel(int j, int level, unsigned long ms);
+
+  /**
+   * Select the light servos sweep profile. Invalid IDs are ignored
+   * 
+   * @param p The profile ID (SWEEP_xxx)
+   */
+  void setSweepProfile(int p);
+
+  /**
+   * Get the current light servos sweep profile
+   */
+  int getSweepProfile();
+
+  /**
+   * Check if PIR has detected a motion. If true, the mp3 player is triggered
+   * and the timer counter is initialized. The sensor is not polled: the level
+   * changes are detected by the PIR interrupt and only a real transition
+   * changes the status of the machine.
+   * 
+   * \Note To make easy the program main loop control, the PIR status take into
+   * account of the mqtt remote command flag status. The detections are ignored
+   * for PRESENCE_COOLDOWN ms after the end of a cycle.
+   */
+  void checkPirStatus();
+
+  /**
+   * Check if a remote command (via the mqtt protocol) has been received. 
+   * If true, the specific features are started accordingly with the
+   * mqtt received message. The command sequence continues in the
+   * following loop cycles while updateHardware() is called.
+   * 
+   * \note The commands are taken from the queue, one at a time: the
+   * next command is started when the previous sequence has been completed.
+   */
+  void mqttCheckStatus();
+
+  /**
+   * When a remote command via mqtt is received (via the callback function)
+   * the normal status of the operation is interrupted the next loop cycle.
+   * 
+   * \note The MQTT callback function only set the parameters in the MachineState
+   * structure. If the mqtt flag is set also a command is passed to the satus
+   * structure, to be executed the next loop cycle the check MQTT status is
+   * called.
+   */
+  void mqttExecCommand();
+
+  /**
+   * Add a command, with the default parameters, to the commands queue
+   * 
+   * @param cmd The command ID
+   * @return false if the command has been dropped because the queue is full
+   */
+  boolean mqttSetCommand(int cmd);
+
+  /**
+   * Add a command and its parameters to the commands queue
+   * 
+   * @param cmd The command
+   * @return false if the command has been dropped because the queue is full
+   */
+  boolean mqttSetCommand(MqttCommand &cmd);
+
+  /**
+   * Get the remote commands queue, e.g. to read the counters
+   */
+  CommandQueue& getCommandQueue();
+
+  /**
+   * Executes a series of musics on the player starting from the last music played.
+   * 
+   * The mp3 player is a different board. When the serial link is connected
+   * every song is started with a single next track command. Without the
+   * link the trigger pin is released and set again: every time a music
+   * start/end on the mp3 player it moves to the next in its own internal list.
+   * 
+   * \note The method only starts the sequence, the songs are switched by the
+   * scheduled steps.
+   */
+  void mqttCmdMusic();
+
+  /**
+   * Shows the lights (high intensity) for a limited period of time.
+   * The method returns immediately, the lights are powered off by a scheduled step.
+   * 
+   * @param to The amount of seconds the light should be shown
+   */
+  void mqttCmdLights(int to);
+
+  /**
+   * Power on the lights
+   */
+  void mqttCmdLights();
+
+  /**
+   * Executes a complete sequence: power on the lights, plays some music then goes off.
+   * As the music command, the sequence continues in the scheduled steps.
+   */
+  void mqttCmdRun();
+
+  /**
+   * Play a show. The command level is the show ID. The show is advanced by
+   * updateHardware() and the command ends with the show
+   */
+  void mqttCmdShow();
+
+  /**
+   * Load the show received from remote, played by the show command
+   * with the SHOW_USER ID
+   * 
+   * @param frame The show frame
+   * @param length The frame length
+   * @return false if the show is not valid
+   */
+  boolean mqttLoadShow(const byte frame[], int length);
+
+  /**
+   * Disable the mqtt remote command flah and stop the carosel
+   */
+  void mqttEndCarousel();
+
+  /**
+   * Disable the pir status and stop the carousel
+   */
+  void endCarousel();
+  
+  /**
+   * Initialize the machine status parameters atn boot
+   */
+  void initStatus();
+
+  /**
+   * Initialize the hardware pins and set the hardware servos and 
+   * lights to the initial state
+   */
+  void initHardware();
+
+  /**
+   * Set the loop profiler measuring the light servos steps delay
+   * 
+   * @param p The profiler, NULL to stop measuring
+   */
+  void setProfiler(Profiler *p);
+
+  /**
+   * Update the hardware components (servos, lilghts) accordingly
+   * with the status of the machine and run the scheduled tasks
+   */
+  void updateHardware();
+};
+
+ #endif
@@ -0,0 +1,84 @@
+/**
+ * \file struct.h
+ * \brief Data structures to control the status of the parameters
+ * 
+ * \date May 2019
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * 
+ */
+
+#include "Arduino.h"
+#include "globals.h"
+
+#ifndef _STRUCTS
+#define _STRUCTS
+
+//! Remote command with its parameters. The parameters set to 0
+//! use the command defaults
+typedef struct {
+    int id;                    ///< Command ID
+    byte seq;                  ///< Sequence number set by the sender
+    byte priority;             ///< Queue priority, higher values are executed first
+    unsigned int duration;     ///< Duration (s) of the lights or of every song
+    int level;                 ///< Light intensity or sweep profile ID
+    int count;                 ///< Number of songs
+} MqttCommand;
+
+//! Status of the sound board, as notified on the serial link
+typedef struct {
+    int track;                 ///< Track playing, 0 if the player is stopped
+    int lastEnded;             ///< Last track finished
+    unsigned long ended;       ///< Number of tracks finished
+} SoundStatus;
+
+//! Structure defining the status flags of the machine
+typedef struct MachineStatus {
+    boolean music;             ///< The status of the mp3 player
+    boolean pir;               ///< The status of the PIR sensor
+    boolean pirLevel;          ///< Last debounced PIR sensor level
+    boolean pirPending;        ///< PIR level waiting to be stable for the debounce time
+    unsigned long pirEdge;     ///< Time (ms) the pending PIR level has been read
+    unsigned long pirDetection; ///< Time (ms) of the last motion detection
+    boolean mqtt;              ///< THE STATUS OF THE MQTT remote command
+    MqttCommand mqttCommand;   ///< The current command received from remote
+    int mqttStep;              ///< Next step of the running remote command sequence
+    int mqttSongs;             ///< Songs left to play in the running remote command sequence
+    int wheel;                 ///< The rotating wheel speed
+    boolean isRotating;        ///< Wheel status
+    int light;                 ///< The current light intensity
+    int servoPos[NUMLIGHTS];   ///< Last positon of the light rotating servos
+    int sweepProfile;          ///< Light servos sweep profile ID
+    int sweepStep;             ///< Current step of the light servos sweep
+    /**
+     * Reading of the timer when the PIR status has been detected
+     * It is reset everytime the pir status is read positive
+     */
+    unsigned long timerStart;
+    /**
+     * Laset millis read to temporize the servo lights rotation
+     * continuously. The value is checked/updated everytime the 
+     * updateHardware() is called.
+     */
+    unsigned long timerServo;
+};
+
+//! MQTT message structure. Lifetime counters, saved in flash
+typedef struct IoTmessage {
+  //! Number of detections
+  unsigned long detections;
+  //! Total number of minutes played
+  unsigned long minutesPlayed;
+  //! Milliseconds played in the current minute
+  unsigned long playedMs;
+  //! Number of complete wheels rotations
+  unsigned long wheelRotations;
+  //! Current partial rotation (speed by ms, see accounting.h)
+  unsigned long rotationUnits;
+  //! Total number of spheres cycles in the carousel
+  unsigned long numSpheres;
+  //! Current partial sphere (speed by ms, see accounting.h)
+  unsigned long sphereUnits;
+};
+
+#endif
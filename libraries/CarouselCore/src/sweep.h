@@ -0,0 +1,95 @@
+/**
+ * \file sweep.h
+ * \brief Precomputed light servos sweep profiles
+ *
+ * A sweep is a complete back and forth movement of a light servo between
+ * MIN_ANGLE and MAX_ANGLE in SWEEP_STEPS steps. The servo positions of every
+ * profile are calculated by the compiler and stored in the SweepTable::positions
+ * array, so moving the servos is a single table read for every step.
+ *
+ * Available profiles:
+ * - SWEEP_LINEAR one degree every step, bouncing at the limits
+ * - SWEEP_SINE smooth sine movement, slowing down near the limits
+ * - SWEEP_DWELL linear movement with a pause of SWEEP_DWELL_STEPS at the limits
+ *
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _SWEEP
+#define _SWEEP
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! Steps needed to go from MIN_ANGLE to MAX_ANGLE, half of the sweep
+#define SWEEP_HALF (SWEEP_STEPS / 2)
+//! Sweep amplitude (degrees)
+#define SWEEP_RANGE (MAX_ANGLE - MIN_ANGLE)
+
+// ========================================== Profile functions
+
+//! Distance of the step from the start of the sweep, going back after the half
+constexpr int sweepDistance(int j) {
+  return (j < SWEEP_HALF) ? j : SWEEP_STEPS - j;
+}
+
+//! Linear sweep position
+constexpr int sweepLinear(int j) {
+  return MIN_ANGLE + sweepDistance(j) * SWEEP_RANGE / SWEEP_HALF;
+}
+
+//! Cosine of x (0 to PI) calculated with the Taylor series
+constexpr double sweepCos(double x, int n = 1, double term = 1.0, double sum = 1.0) {
+  return (n > 12) ? sum :
+    sweepCos(x, n + 1, -term * x * x / ((2 * n - 1) * (2 * n)),
+             sum - term * x * x / ((2 * n - 1) * (2 * n)));
+}
+
+//! Sine sweep position
+constexpr int sweepSine(int j) {
+  return MIN_ANGLE + int(SWEEP_RANGE * (1.0 - sweepCos(3.14159265 * sweepDistance(j) / SWEEP_HALF)) / 2.0 + 0.5);
+}
+
+//! Linear sweep position with a pause at the limits
+constexpr int sweepDwell(int j) {
+  return (sweepDistance(j) <= SWEEP_DWELL_STEPS / 2) ? MIN_ANGLE :
+         (sweepDistance(j) >= SWEEP_HALF - SWEEP_DWELL_STEPS / 2) ? MAX_ANGLE :
+         MIN_ANGLE + (sweepDistance(j) - SWEEP_DWELL_STEPS / 2) * SWEEP_RANGE / (SWEEP_HALF - SWEEP_DWELL_STEPS);
+}
+
+// ========================================== Table generation
+
+//! List of the sweep step indexes
+template<int... I> struct SweepIndex {};
+
+//! Build the list of the sweep step indexes 0 .. N-1
+template<int N, int... I> struct MakeSweepIndex : MakeSweepIndex<N - 1, N - 1, I...> {};
+template<int... I> struct MakeSweepIndex<0, I...> {
+  typedef SweepIndex<I...> type;
+};
+
+//! Sweep positions table, calculated for every index of the list
+template<class T> struct SweepTableOf;
+template<int... I> struct SweepTableOf< SweepIndex<I...> > {
+  //! Servo positions by profile and step
+  static constexpr byte positions[NUMSWEEPS][SWEEP_STEPS] = {
+    { sweepLinear(I)... },
+    { sweepSine(I)... },
+    { sweepDwell(I)... }
+  };
+};
+template<int... I> constexpr byte SweepTableOf< SweepIndex<I...> >::positions[NUMSWEEPS][SWEEP_STEPS];
+
+//! The sweep table used by the light servos
+typedef SweepTableOf< MakeSweepIndex<SWEEP_STEPS>::type > SweepTable;
+
+//! A group of light servos moving together
+typedef struct {
+  int servos[MAX_GROUP_SERVOS]; ///< Servo indexes
+  int numServos;                ///< Number of servos in the group
+  int offset;                   ///< Sweep step offset of the group
+} ServoGroup;
+
+#endif
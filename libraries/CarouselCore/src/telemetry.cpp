@@ -0,0 +1,128 @@
+/**
+ * \file telemetry.cpp
+ * \brief Telemetry sampler and publisher
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#include "telemetry.h"
+
+void Telemetry::begin(unsigned long now) {
+  count = 0;
+  timerSample = now;
+  timerPublish = now;
+  interval = TELEMETRY_PUBLISH_INTERVAL;
+  loopMax = 0;
+  failures = 0;
+  // Force the first sample to be kept
+  memset(&last, 0, sizeof(last));
+  last.time = now - TELEMETRY_HEARTBEAT;
+  last.wheel = -1;
+}
+
+boolean Telemetry::isChanged(TelemetrySample &s) {
+  int j;
+
+  if( (s.time - last.time) >= TELEMETRY_HEARTBEAT) {
+    return true;
+  }
+  if( (s.pir != last.pir) || (s.wheel != last.wheel) || (s.light != last.light) ) {
+    return true;
+  }
+  for(j = 0; j < NUMLIGHTS; j++) {
+    if(abs(s.servoPos[j] - last.servoPos[j]) >= TELEMETRY_SERVO_DELTA) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Telemetry::addLoop(unsigned long us) {
+  if(us > loopMax) {
+    loopMax = us;
+  }
+}
+
+void Telemetry::update(StateMachine &carousel, unsigned long now) {
+  TelemetrySample s;
+  int j;
+
+  if( (now - timerSample) < TELEMETRY_SAMPLE_INTERVAL) {
+    return;
+  }
+  timerSample = now;
+
+  s.time = now;
+  s.pir = carousel.isPir();
+  s.wheel = carousel.getWheel();
+  s.light = carousel.getLight();
+  for(j = 0; j < NUMLIGHTS; j++) {
+    s.servoPos[j] = carousel.getServoPos(j);
+  }
+  s.loopTime = loopMax;
+  loopMax = 0;
+
+  // Keep only the changes. If the batch is full (the publish is
+  // failing) the oldest sample is lost
+  if(isChanged(s)) {
+    if(count == TELEMETRY_BATCH) {
+      for(j = 1; j < TELEMETRY_BATCH; j++) {
+        samples[j - 1] = samples[j];
+      }
+      count--;
+    }
+    samples[count] = s;
+    count++;
+    last = s;
+  }
+}
+
+boolean Telemetry::isPublishDue(unsigned long now) {
+  if(count == 0) {
+    return false;
+  }
+  // After a failure wait for the interval also if the batch is full
+  if( (count == TELEMETRY_BATCH) && (interval == TELEMETRY_PUBLISH_INTERVAL) ) {
+    return true;
+  }
+  return (now - timerPublish) >= interval;
+}
+
+void Telemetry::write(JsonWriter &json) {
+  int j, k;
+
+  json.beginArray("samples");
+  for(j = 0; j < count; j++) {
+    json.beginObject();
+    json.add("t", samples[j].time);
+    json.add("pir", samples[j].pir);
+    json.add("wheel", samples[j].wheel);
+    json.add("light", samples[j].light);
+    json.beginArray("servos");
+    for(k = 0; k < NUMLIGHTS; k++) {
+      json.add(NULL, samples[j].servoPos[k]);
+    }
+    json.endArray();
+    json.add("loop", samples[j].loopTime);
+    json.endObject();
+  }
+  json.endArray();
+}
+
+void Telemetry::published(boolean ok, unsigned long now) {
+  timerPublish = now;
+  if(ok == true) {
+    count = 0;
+    interval = TELEMETRY_PUBLISH_INTERVAL;
+  } else {
+    // Back off
+    failures++;
+    interval = min(interval * 2, TELEMETRY_MAX_INTERVAL);
+  }
+}
+
+unsigned long Telemetry::getFailures() {
+  return failures;
+}
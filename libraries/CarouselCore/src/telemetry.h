@@ -0,0 +1,121 @@
+/**
+ * \file telemetry.h
+ * \brief Telemetry sampler and publisher
+ * 
+ * The state of the carousel (PIR, wheel, lights, light servos and loop timing)
+ * is sampled every TELEMETRY_SAMPLE_INTERVAL ms. A sample is kept only if it is
+ * different from the previous one (delta), or if nothing changed for
+ * TELEMETRY_HEARTBEAT ms. The samples are published in batches: a single
+ * message contains all the samples collected since the last publish.
+ * 
+ * A message is ready when the batch is full or when TELEMETRY_PUBLISH_INTERVAL
+ * ms have passed since the last publish. If the publish fails the interval
+ * is doubled, up to TELEMETRY_MAX_INTERVAL, so a congested link is not flooded.
+ * It goes back to the default after a successful publish.
+ * 
+ * The telemetry doesn't depend on the MQTT client: the caller writes the
+ * batch to the message stream and reports the publish result.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _TELEMETRY
+#define _TELEMETRY
+
+#include "Arduino.h"
+#include "globals.h"
+#include "statemachine.h"
+#include "jsonwriter.h"
+
+//! A telemetry sample
+typedef struct {
+  unsigned long time;         ///< Sample time (ms)
+  boolean pir;                ///< PIR status
+  int wheel;                  ///< Wheel speed
+  int light;                  ///< Light intensity
+  int servoPos[NUMLIGHTS];    ///< Light servos position
+  unsigned long loopTime;     ///< Longest loop duration (us) since the previous sample, idle sleep excluded
+} TelemetrySample;
+
+//! Telemetry sampler and publisher
+class Telemetry {
+  private:
+  //! Samples waiting to be published
+  TelemetrySample samples[TELEMETRY_BATCH];
+  //! Number of samples waiting
+  int count;
+  //! Last sample kept, to calculate the deltas
+  TelemetrySample last;
+  //! Time (ms) of the last sample taken
+  unsigned long timerSample;
+  //! Time (ms) of the last publish
+  unsigned long timerPublish;
+  //! Current publish interval (ms)
+  unsigned long interval;
+  //! Longest loop duration (us) since the last sample
+  unsigned long loopMax;
+  //! Number of failed publish
+  unsigned long failures;
+
+  /**
+   * Return true if the sample is different enough from the last one kept
+   */
+  boolean isChanged(TelemetrySample &s);
+
+  public:
+  /**
+   * Initialize the telemetry
+   * 
+   * @param now The current time (ms)
+   */
+  void begin(unsigned long now);
+
+  /**
+   * Sample the carousel state if it is time. Should be called every loop
+   * cycle
+   * 
+   * @param carousel The state machine
+   * @param now The current time (ms)
+   */
+  void update(StateMachine &carousel, unsigned long now);
+
+  /**
+   * Add the duration of a loop, the idle sleep excluded
+   * 
+   * @param us The loop duration (us)
+   */
+  void addLoop(unsigned long us);
+
+  /**
+   * Return true if a batch of samples should be published
+   * 
+   * @param now The current time (ms)
+   */
+  boolean isPublishDue(unsigned long now);
+
+  /**
+   * Write the batch of samples as the "samples" Json array. The caller
+   * opens and closes the message object, so other data can be added
+   * 
+   * @param json The Json writer of the message
+   */
+  void write(JsonWriter &json);
+
+  /**
+   * Report the result of the publish. On success the batch is emptied
+   * else it is kept and the publish interval is increased
+   * 
+   * @param ok True if the message has been published
+   * @param now The current time (ms)
+   */
+  void published(boolean ok, unsigned long now);
+
+  /**
+   * Return the number of failed publish
+   */
+  unsigned long getFailures();
+};
+
+#endif
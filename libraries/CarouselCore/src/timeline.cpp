@@ -0,0 +1,61 @@
+/**
+ * \file timeline.cpp
+ * \brief Compact timeline of the state machine transitions
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#include "timeline.h"
+
+Timeline::Timeline() {
+  clear();
+}
+
+void Timeline::record(unsigned long t, char kind, int value) {
+  events[head].time = t;
+  events[head].kind = kind;
+  events[head].value = value;
+  head = (head + 1) % TIMELINE_SIZE;
+  if(count < TIMELINE_SIZE) {
+    count++;
+  } else {
+    // The oldest transition has been overwritten
+    lost++;
+  }
+}
+
+int Timeline::size() {
+  return count;
+}
+
+unsigned long Timeline::getLost() {
+  return lost;
+}
+
+Transition Timeline::get(int j) {
+  // The oldest transition is count positions before the head
+  return events[(head - count + j + TIMELINE_SIZE) % TIMELINE_SIZE];
+}
+
+void Timeline::clear() {
+  head = 0;
+  count = 0;
+  lost = 0;
+}
+
+void Timeline::dump(Print &out) {
+  int j;
+  Transition tr;
+
+  for(j = 0; j < count; j++) {
+    tr = get(j);
+    out.print(tr.time);
+    out.print(' ');
+    out.print(tr.kind);
+    out.print(' ');
+    out.println(tr.value);
+  }
+  clear();
+}
@@ -0,0 +1,84 @@
+/**
+ * \file timeline.h
+ * \brief Compact timeline of the state machine transitions
+ * 
+ * Every change of the wheel, lights, light servos direction, music trigger, PIR
+ * and remote command state is recorded with its timestamp in a small circular
+ * buffer. When the buffer is full the oldest transitions are overwritten.
+ * The timeline can be dumped to any Print stream (e.g. Serial) one transition
+ * per line in the format <ms> <kind> <value>, where kind is one of the
+ * TRANSITION_xxx characters.
+ * 
+ * \author Enrico Miglino <balearicdynamics@gmail.com>
+ * \version V 1.0.2
+ * \date May 2019
+ */
+
+#ifndef _TIMELINE
+#define _TIMELINE
+
+#include "Arduino.h"
+#include "globals.h"
+
+//! A single recorded transition
+typedef struct {
+  unsigned long time;   ///< Time (ms) of the transition
+  char kind;            ///< What changed (one of the TRANSITION_xxx IDs)
+  int value;            ///< New value
+} Transition;
+
+//! Circular buffer of the last transitions
+class Timeline {
+  private:
+  //! Recorded transitions
+  Transition events[TIMELINE_SIZE];
+  //! Index of the next transition to write
+  int head;
+  //! Number of valid transitions in the buffer
+  int count;
+  //! Number of transitions overwritten before being read
+  unsigned long lost;
+
+  public:
+  Timeline();
+
+  /**
+   * Add a transition to the timeline
+   * 
+   * @param t The time of the transition (ms)
+   * @param kind The transition ID
+   * @param value The new value
+   */
+  void record(unsigned long t, char kind, int value);
+
+  /**
+   * Return the number of transitions in the timeline
+   */
+  int size();
+
+  /**
+   * Return the number of transitions lost due the buffer overflow
+   */
+  unsigned long getLost();
+
+  /**
+   * Return a transition, from the oldest (0) to the last one (size() - 1)
+   * 
+   * @param j The transition index
+   */
+  Transition get(int j);
+
+  /**
+   * Empty the timeline
+   */
+  void clear();
+
+  /**
+   * Print the timeline, one transition per line, then empty it
+   * 
+   * @param out The output stream
+   */
+  void dump(Print &out);
+};
+
+#endif